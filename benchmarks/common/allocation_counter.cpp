@@ -0,0 +1,41 @@
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+    std::atomic<size_t> allocation_count{0};
+    std::atomic<size_t> allocated_bytes{0};
+
+}  // namespace
+
+void *operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *ptr{std::malloc(size ? size : 1)}) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+namespace silkworm::benchmarks {
+
+    AllocationCounter::AllocationCounter()
+            : initial_count_{allocation_count.load(std::memory_order_relaxed)},
+              initial_bytes_{allocated_bytes.load(std::memory_order_relaxed)} {}
+
+    size_t AllocationCounter::count() const {
+        return allocation_count.load(std::memory_order_relaxed) - initial_count_;
+    }
+
+    size_t AllocationCounter::bytes() const {
+        return allocated_bytes.load(std::memory_order_relaxed) - initial_bytes_;
+    }
+
+}  // namespace silkworm::benchmarks
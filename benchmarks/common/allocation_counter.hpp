@@ -0,0 +1,26 @@
+#ifndef SILKWORM_BENCHMARKS_ALLOCATION_COUNTER_HPP
+#define SILKWORM_BENCHMARKS_ALLOCATION_COUNTER_HPP
+
+#include <cstddef>
+
+namespace silkworm::benchmarks {
+
+// Counts the heap allocations made through the global operator new since construction
+    class AllocationCounter {
+    public:
+        AllocationCounter();
+
+        //! \brief Number of allocations since construction
+        [[nodiscard]] size_t count() const;
+
+        //! \brief Number of bytes allocated since construction
+        [[nodiscard]] size_t bytes() const;
+
+    private:
+        size_t initial_count_;
+        size_t initial_bytes_;
+    };
+
+}  // namespace silkworm::benchmarks
+
+#endif // SILKWORM_BENCHMARKS_ALLOCATION_COUNTER_HPP
@@ -0,0 +1,47 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/util.hpp>
+
+namespace silkworm {
+
+TEST_CASE("keccak256_batch throughput") {
+    // Leaf-sized inputs, each fitting in a single block
+    std::vector<Bytes> data(1'024, Bytes(110, 0));
+    for (size_t i{0}; i < data.size(); ++i) {
+        data[i][0] = static_cast<uint8_t>(i);
+        data[i][1] = static_cast<uint8_t>(i >> 8);
+    }
+    const std::vector<ByteView> inputs(data.begin(), data.end());
+    std::vector<ethash::hash256> outputs(inputs.size());
+
+    for (const auto backend : {KeccakBackend::kScalar, KeccakBackend::kAvx2, KeccakBackend::kAvx512}) {
+        if (backend > keccak256_batch_backend()) {
+            continue;
+        }
+        BENCHMARK("keccak256_batch 1k inputs, backend " + std::to_string(static_cast<int>(backend))) {
+            keccak256_batch(inputs, outputs, backend);
+            return outputs[0];
+        };
+    }
+}
+
+}  // namespace silkworm
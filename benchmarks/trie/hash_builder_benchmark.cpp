@@ -0,0 +1,186 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/endian.hpp>
+#include <merkle-patricia-tree/common/util.hpp>
+#include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/nibbles.hpp>
+
+#include "../common/allocation_counter.hpp"
+
+namespace silkworm::trie {
+
+using benchmarks::AllocationCounter;
+
+// Sorted hashed keys along with account-sized values, as in the state trie
+static std::vector<std::pair<Bytes, Bytes>> hashed_leaves(size_t count) {
+    std::vector<std::pair<Bytes, Bytes>> leaves;
+    leaves.reserve(count);
+    for (size_t i{0}; i < count; ++i) {
+        uint8_t index[8];
+        endian::store_big_u64(index, i);
+        const ethash::hash256 key{keccak256(index)};
+        leaves.emplace_back(unpack_nibbles(key.bytes), Bytes(70, static_cast<uint8_t>(i)));
+    }
+    std::sort(leaves.begin(), leaves.end());
+    return leaves;
+}
+
+TEST_CASE("HashBuilder steady-state allocations") {
+    const auto leaves{hashed_leaves(10'000)};
+    HashBuilder hb;
+
+    // Warm-up lets the internal buffers grow to the maximum depth of the trie
+    for (const auto& [key, value] : leaves) {
+        hb.add_leaf(key, value);
+    }
+    const evmc::bytes32 expected_root{hb.root_hash()};
+    hb.reset();
+
+    // Keys are handed over to the builder, so that copying them doesn't count
+    std::vector<Bytes> keys;
+    keys.reserve(leaves.size());
+    for (const auto& [key, _] : leaves) {
+        keys.push_back(key);
+    }
+
+    evmc::bytes32 root;
+    size_t allocations{0};
+    {
+        AllocationCounter counter;
+        for (size_t i{0}; i < leaves.size(); ++i) {
+            hb.add_leaf(std::move(keys[i]), leaves[i].second);
+        }
+        root = hb.root_hash();
+        allocations = counter.count();
+    }
+    CHECK(root == expected_root);
+    CHECK(allocations == 0);
+
+    BENCHMARK("HashBuilder 10k leaves") {
+        HashBuilder builder;
+        for (const auto& [key, value] : leaves) {
+            builder.add_leaf(key, value);
+        }
+        return builder.root_hash();
+    };
+
+    BENCHMARK("HashBuilderT<NoCollector> 10k leaves") {
+        HashBuilderT<NoCollector> builder;
+        for (const auto& [key, value] : leaves) {
+            builder.add_leaf(key, value);
+        }
+        return builder.root_hash();
+    };
+
+    BENCHMARK("HashedKeyHashBuilder<NoCollector> 10k leaves") {
+        HashedKeyHashBuilder<NoCollector> builder;
+        for (const auto& [key, value] : leaves) {
+            builder.add_leaf(key, value);
+        }
+        return builder.root_hash();
+    };
+
+    std::vector<Bytes> packed_keys;
+    packed_keys.reserve(leaves.size());
+    for (const auto& [key, _] : leaves) {
+        packed_keys.push_back(pack_nibbles(key));
+    }
+    BENCHMARK("HashBuilder 10k packed leaves") {
+        HashBuilder builder;
+        for (size_t i{0}; i < leaves.size(); ++i) {
+            builder.add_leaf(PackedNibbles{packed_keys[i]}, leaves[i].second);
+        }
+        return builder.root_hash();
+    };
+}
+
+// Leaves read from a flat snapshot, as if memory-mapped: packed keys and values laid out back to back
+TEST_CASE("HashBuilder bytes copied per leaf") {
+    static constexpr size_t kKeyLength{kHashLength};
+    static constexpr size_t kValueLength{70};
+
+    const auto leaves{hashed_leaves(10'000)};
+    Bytes snapshot;
+    for (const auto& [key, value] : leaves) {
+        snapshot.append(pack_nibbles(key));
+        snapshot.append(value);
+    }
+    const auto leaf_at{[&snapshot](size_t i) {
+        const ByteView record{ByteView{snapshot}.substr(i * (kKeyLength + kValueLength), kKeyLength + kValueLength)};
+        return std::make_pair(record.substr(0, kKeyLength), record.substr(kKeyLength));
+    }};
+
+    HashBuilder hb;
+    const auto report{[&](const std::string& mode, auto&& add_leaf) {
+        // Warm-up, so that only the steady state is measured
+        for (size_t i{0}; i < leaves.size(); ++i) {
+            add_leaf(i);
+        }
+        const evmc::bytes32 expected_root{hb.root_hash()};
+        hb.reset();
+
+        AllocationCounter counter;
+        for (size_t i{0}; i < leaves.size(); ++i) {
+            add_leaf(i);
+        }
+        CHECK(hb.root_hash() == expected_root);
+        const size_t allocated{counter.bytes()};
+        const size_t copied{hb.bytes_copied()};
+        hb.reset();
+        WARN(mode << ": " << copied / leaves.size() << " bytes copied by the builder, " << allocated / leaves.size()
+                  << " bytes allocated per leaf");
+        return std::make_pair(copied, allocated);
+    }};
+
+    // The key is unpacked by the caller (allocating), then packed back by the builder, which copies the value as well
+    const auto unpacked{report("unpacked", [&](size_t i) {
+        const auto [key, value]{leaf_at(i)};
+        hb.add_leaf(unpack_nibbles(key), value);
+    })};
+    CHECK(unpacked.first == leaves.size() * (kKeyLength + kValueLength));
+    const auto packed{report("packed", [&](size_t i) {
+        const auto [key, value]{leaf_at(i)};
+        hb.add_leaf(PackedNibbles{key}, value);
+    })};
+    CHECK(packed.first == leaves.size() * (kKeyLength + kValueLength));
+    CHECK(packed.second == 0);
+    const auto borrowed{report("borrowed", [&](size_t i) {
+        const auto [key, value]{leaf_at(i)};
+        hb.add_leaf_borrowed(PackedNibbles{key}, value);
+    })};
+    CHECK(borrowed.first == 0);
+    CHECK(borrowed.second == 0);
+
+    BENCHMARK("HashBuilder 10k borrowed leaves") {
+        HashBuilder builder;
+        for (size_t i{0}; i < leaves.size(); ++i) {
+            const auto [key, value]{leaf_at(i)};
+            builder.add_leaf_borrowed(PackedNibbles{key}, value);
+        }
+        return builder.root_hash();
+    };
+}
+
+}  // namespace silkworm::trie
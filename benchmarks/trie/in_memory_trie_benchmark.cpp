@@ -0,0 +1,61 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <map>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/endian.hpp>
+#include <merkle-patricia-tree/common/util.hpp>
+#include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/in_memory_trie.hpp>
+#include <merkle-patricia-tree/trie/nibbles.hpp>
+
+namespace silkworm::trie {
+
+// One write followed by the root, as for the pending state: rehashing the dirty path vs. all the leaves
+TEST_CASE("InMemoryTrie root after a single write") {
+    std::map<Bytes, Bytes> entries;
+    InMemoryTrie trie;
+    for (uint64_t i{0}; i < 10'000; ++i) {
+        uint8_t index[8];
+        endian::store_big_u64(index, i);
+        const Bytes key{keccak256(index).bytes, kHashLength};
+        const Bytes value(70, static_cast<uint8_t>(i));
+        trie.put(key, value);
+        entries.emplace(key, value);
+    }
+    CHECK(trie.root_hash() != evmc::bytes32{});
+
+    const Bytes key{entries.begin()->first};
+    uint8_t counter{0};
+    BENCHMARK("InMemoryTrie 10k leaves, put and root_hash") {
+        trie.put(key, Bytes(70, ++counter));
+        return trie.root_hash();
+    };
+
+    BENCHMARK("HashBuilder 10k leaves, put and root_hash") {
+        entries[key] = Bytes(70, ++counter);
+        HashBuilder hb;
+        for (const auto& [k, v] : entries) {
+            hb.add_leaf(PackedNibbles{k}, v);
+        }
+        return hb.root_hash();
+    };
+}
+
+}  // namespace silkworm::trie
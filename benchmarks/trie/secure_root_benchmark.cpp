@@ -0,0 +1,73 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/endian.hpp>
+#include <merkle-patricia-tree/common/thread_pool.hpp>
+#include <merkle-patricia-tree/common/util.hpp>
+#include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/nibbles.hpp>
+#include <merkle-patricia-tree/trie/secure_root.hpp>
+
+namespace silkworm::trie {
+
+TEST_CASE("Secure root of 100k accounts") {
+    std::vector<Bytes> keys;
+    std::vector<Bytes> values;
+    for (uint64_t i{0}; i < 100'000; ++i) {
+        Bytes key(20, 0);
+        endian::store_big_u64(&key[12], i);
+        keys.push_back(std::move(key));
+        values.emplace_back(70, static_cast<uint8_t>(i));
+    }
+    std::vector<std::pair<ByteView, ByteView>> entries;
+    for (size_t i{0}; i < keys.size(); ++i) {
+        entries.emplace_back(keys[i], values[i]);
+    }
+
+    // What each caller used to do: hash one by one, unpack, sort and add
+    const auto naive{[&] {
+        std::vector<std::pair<Bytes, ByteView>> leaves;
+        leaves.reserve(entries.size());
+        for (const auto& [key, value] : entries) {
+            leaves.emplace_back(unpack_nibbles(keccak256(key).bytes), value);
+        }
+        std::sort(leaves.begin(), leaves.end());
+        HashBuilder hb;
+        for (const auto& [key, value] : leaves) {
+            hb.add_leaf(key, value);
+        }
+        return hb.root_hash();
+    }};
+
+    ThreadPool pool;
+    CHECK(secure_root_hash(entries) == naive());
+    CHECK(secure_root_hash(entries, &pool) == naive());
+
+    BENCHMARK("Hash, unpack, sort and HashBuilder") { return naive(); };
+
+    BENCHMARK("secure_root_hash") { return secure_root_hash(entries); };
+
+    BENCHMARK("secure_root_hash on a thread pool") { return secure_root_hash(entries, &pool); };
+}
+
+}  // namespace silkworm::trie
@@ -0,0 +1,82 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/thread_pool.hpp>
+#include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/nibbles.hpp>
+#include <merkle-patricia-tree/trie/unsorted_root.hpp>
+
+namespace silkworm::trie {
+
+TEST_CASE("Unsorted root of 200k hashed keys") {
+    std::mt19937_64 rng{42};
+    std::vector<Bytes> keys;
+    std::vector<Bytes> values;
+    for (size_t i{0}; i < 200'000; ++i) {
+        Bytes key(kHashLength, 0);
+        for (auto& b : key) {
+            b = static_cast<uint8_t>(rng());
+        }
+        keys.push_back(std::move(key));
+        values.emplace_back(70, static_cast<uint8_t>(i));
+    }
+    std::vector<std::pair<ByteView, ByteView>> entries;
+    for (size_t i{0}; i < keys.size(); ++i) {
+        entries.emplace_back(keys[i], values[i]);
+    }
+
+    // What each caller used to do: sort by comparison, then add
+    const auto naive{[&] {
+        std::vector<std::pair<ByteView, ByteView>> sorted{entries};
+        std::sort(sorted.begin(), sorted.end());
+        HashBuilder hb;
+        for (const auto& [key, value] : sorted) {
+            hb.add_leaf(PackedNibbles{key}, value);
+        }
+        return hb.root_hash();
+    }};
+
+    ThreadPool pool;
+    CHECK(unsorted_root_hash(entries) == naive());
+    CHECK(unsorted_root_hash(entries, &pool) == naive());
+
+    BENCHMARK("std::sort") {
+        std::vector<std::pair<ByteView, ByteView>> sorted{entries};
+        std::sort(sorted.begin(), sorted.end());
+        return sorted.size();
+    };
+
+    BENCHMARK("radix_sort") {
+        std::vector<std::pair<ByteView, ByteView>> sorted{entries};
+        return radix_sort(sorted)[0];
+    };
+
+    BENCHMARK("std::sort and HashBuilder") { return naive(); };
+
+    BENCHMARK("unsorted_root_hash") { return unsorted_root_hash(entries); };
+
+    BENCHMARK("unsorted_root_hash on a thread pool") { return unsorted_root_hash(entries, &pool); };
+}
+
+}  // namespace silkworm::trie
@@ -0,0 +1,115 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKWORM_COMMON_FILE_HPP
+#define SILKWORM_COMMON_FILE_HPP
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "merkle-patricia-tree/common/bytes.hpp"
+
+namespace silkworm {
+
+    struct FileCloser {
+        void operator()(std::FILE *file) const noexcept { std::fclose(file); }
+    };
+
+    using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+//! \brief Same as std::fopen, the path being made of wide characters on Windows
+//! \return nullptr on failure
+    FilePtr open_file(const std::filesystem::path &path, const char *mode);
+
+//! \brief Same as std::fseek with a 64-bit offset, whereas long has 32 bits on Windows
+//! \return false on failure
+    bool seek_file(std::FILE *file, int64_t offset, int origin) noexcept;
+
+// A file of records, e.g. the runs of EtlHashBuilder or the leaves of ShardedRootCoordinator, is made of
+// the big-endian 32-bit lengths of the key and of the value of each record, followed by both
+    inline constexpr size_t kRecordHeaderLength{8};
+
+    inline constexpr size_t kDefaultRecordBufferSize{1u << 20};
+
+//! \brief Buffered writer of records
+//! \remarks Methods throw std::runtime_error on I/O errors
+    class RecordWriter {
+    public:
+        explicit RecordWriter(const std::filesystem::path &path, size_t buffer_size = kDefaultRecordBufferSize);
+
+        //! \brief Writes raw bytes, e.g. ahead of the records
+        void write(ByteView bytes);
+
+        void write_record(ByteView key, ByteView value);
+
+        void seek(uint64_t offset);
+
+        //! \brief Flushes the records, whereas the destructor ignores any error
+        void close();
+
+    private:
+        std::filesystem::path path_;
+        std::vector<char> buffer_;  // outlives file_, which uses it
+        FilePtr file_;
+    };
+
+//! \brief Sequential reader of records, holding the current one
+//! \remarks Methods throw std::runtime_error on I/O errors, a cut record included
+    class RecordReader {
+    public:
+        //! \param [in] offset : of the first record to read
+        //! \param [in] end : offset past the last record to read; 0 means the end of the file
+        explicit RecordReader(const std::filesystem::path &path, size_t buffer_size = kDefaultRecordBufferSize,
+                              uint64_t offset = 0, uint64_t end = 0);
+
+        //! \param [in] read_value : whether to read the value, or else skip it
+        //! \return false past the last record
+        bool next(bool read_value = true);
+
+        //! \brief Reads raw bytes, e.g. ahead of the records
+        void read(uint8_t *out, size_t length);
+
+        [[nodiscard]] ByteView key() const noexcept { return key_; }
+
+        [[nodiscard]] ByteView value() const noexcept { return value_; }
+
+        //! \brief Offset of the current record
+        [[nodiscard]] uint64_t record_offset() const noexcept { return record_offset_; }
+
+        //! \brief Offset past the current record
+        [[nodiscard]] uint64_t offset() const noexcept { return offset_; }
+
+    private:
+        std::filesystem::path path_;
+        std::vector<char> buffer_;  // outlives file_, which uses it
+        FilePtr file_;
+        uint64_t offset_;
+        uint64_t end_;
+        uint64_t record_offset_{0};
+        Bytes key_;
+        Bytes value_;
+    };
+
+}  // namespace silkworm
+
+#endif // __cplusplus
+
+#endif // SILKWORM_COMMON_FILE_HPP
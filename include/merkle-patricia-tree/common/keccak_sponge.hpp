@@ -0,0 +1,69 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKWORM_COMMON_KECCAK_SPONGE_HPP
+#define SILKWORM_COMMON_KECCAK_SPONGE_HPP
+
+#include "base.hpp"
+#include "bytes.hpp"
+
+#ifdef __cplusplus
+
+#include <ethash/hash_types.hpp>
+
+namespace silkworm {
+
+// Keccak-256 of data absorbed piece by piece, e.g. the RLP of a node straight from its parts
+// without assembling it in a buffer first
+    class KeccakSponge {
+    public:
+        //! \brief Appends data to the input being hashed
+        void absorb(ByteView data) noexcept;
+
+        void absorb(uint8_t byte) noexcept;
+
+        //! \brief Returns the hash of all the data absorbed so far and resets the sponge
+        ethash::hash256 finalize() noexcept;
+
+        void reset() noexcept;
+
+    private:
+        static constexpr size_t kRate{136};  // bytes absorbed per permutation
+
+        uint64_t state_[25]{};
+        size_t position_{0};  // bytes absorbed into the current block
+    };
+
+}  // namespace silkworm
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct silkworm_KeccakSponge silkworm_KeccakSponge;
+
+silkworm_KeccakSponge *silkworm_KeccakSponge_new();
+void silkworm_KeccakSponge_free(silkworm_KeccakSponge *sponge);
+
+void silkworm_KeccakSponge_absorb(silkworm_KeccakSponge *sponge, silkworm_ByteView data);
+void silkworm_KeccakSponge_finalize(silkworm_KeccakSponge *sponge, uint8_t result[32]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILKWORM_COMMON_KECCAK_SPONGE_HPP
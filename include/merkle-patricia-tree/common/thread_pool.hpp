@@ -0,0 +1,86 @@
+#ifndef SILKWORM_COMMON_THREAD_POOL_HPP
+#define SILKWORM_COMMON_THREAD_POOL_HPP
+
+#ifdef __cplusplus
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace silkworm {
+
+//! \brief A fixed set of worker threads executing submitted tasks in FIFO order
+    class ThreadPool {
+    public:
+        //! \param [in] num_threads : number of workers; 0 means one per hardware thread
+        explicit ThreadPool(size_t num_threads = 0);
+
+        // Not copyable nor movable
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        //! \brief Waits for all the queued tasks to complete and joins the workers
+        ~ThreadPool();
+
+        //! \brief Queues a task for execution
+        //! \return A future holding the result of the task (or the exception it has thrown)
+        template<class F>
+        std::future<std::invoke_result_t<F>> submit(F &&task) {
+            using Result = std::invoke_result_t<F>;
+            auto packaged{std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task))};
+            std::future<Result> result{packaged->get_future()};
+            post([packaged] { (*packaged)(); });
+            return result;
+        }
+
+        [[nodiscard]] size_t size() const { return workers_.size(); }
+
+    private:
+        void post(std::function<void()> task);
+
+        void work();
+
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stopping_{false};
+    };
+
+//! \brief Runs task(begin, end) over [0, count) split in chunks, as tasks of the pool if any, and waits for them
+//! \remarks A single chunk runs on the calling thread; the first exception thrown by a task is rethrown
+    template<class Task>
+    void for_each_chunk(size_t count, size_t chunk, ThreadPool *pool, Task &&task) {
+        if (!pool || count <= chunk) {
+            task(size_t{0}, count);
+            return;
+        }
+        std::vector<std::future<void>> futures;
+        for (size_t begin{0}; begin < count; begin += chunk) {
+            futures.push_back(pool->submit([&task, begin, end{std::min(begin + chunk, count)}] {
+                task(begin, end);
+            }));
+        }
+        // All the tasks must be done with task before an exception unwinds it
+        for (auto &future : futures) {
+            future.wait();
+        }
+        for (auto &future : futures) {
+            future.get();
+        }
+    }
+
+}  // namespace silkworm
+
+#endif // __cplusplus
+
+#endif // SILKWORM_COMMON_THREAD_POOL_HPP
@@ -27,6 +27,7 @@
 #include <iostream>
 #include <optional>
 #include <regex>
+#include <span>
 #include <string_view>
 #include <vector>
 
@@ -114,6 +115,24 @@ namespace silkworm {
 
     inline ethash::hash256 keccak256(ByteView view) { return ethash::keccak256(view.data(), view.size()); }
 
+//! \brief Implementations of keccak256_batch, ordered by the number of inputs hashed at once
+    enum class KeccakBackend {
+        kScalar,  // ethash::keccak256, one input at a time
+        kAvx2,    // 4 inputs per permutation
+        kAvx512,  // 8 inputs per permutation
+    };
+
+//! \brief The fastest KeccakBackend supported by the CPU, detected at runtime
+    KeccakBackend keccak256_batch_backend() noexcept;
+
+//! \brief Computes outputs[i] = keccak256(inputs[i]) for independent inputs, e.g. sibling nodes of a branch
+//! \remarks Inputs spanning the same number of 136-byte blocks are hashed together by the SIMD backends,
+//! thus the batch should be large enough to fill the lanes. outputs must hold at least inputs.size() hashes.
+    void keccak256_batch(std::span<const ByteView> inputs, std::span<ethash::hash256> outputs);
+
+//! \brief Same as above with the backend forced, if supported by the CPU (otherwise the fastest supported one)
+    void keccak256_batch(std::span<const ByteView> inputs, std::span<ethash::hash256> outputs, KeccakBackend backend);
+
 //! \brief Create an intx::uint256 from a string supporting both fixed decimal and scientific notation
     template<UnsignedIntegral Int>
     constexpr Int from_string_sci(const char *str) {
@@ -212,6 +231,7 @@ char *silkworm_human_size(uint64_t bytes, const char *unit);
 bool silkworm_iequals(const char *a, size_t a_length, const char *b, size_t b_length);
 size_t silkworm_prefix_length(silkworm_ByteView a, silkworm_ByteView b);
 void silkworm_keccak256(silkworm_ByteView view, uint8_t result[32]);
+void silkworm_keccak256_batch(const silkworm_ByteView *inputs, size_t count, uint8_t (*outputs)[32]);
 uint64_t silkworm_from_string_sci(const char *str);
 float silkworm_to_float(uint64_t value);
 
@@ -0,0 +1,140 @@
+#ifndef SILKWORM_TRIE_ASYNC_NODE_SINK_HPP
+#define SILKWORM_TRIE_ASYNC_NODE_SINK_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+#include "hash_builder.hpp"
+#include "node.hpp"
+
+#ifdef __cplusplus
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace silkworm::trie {
+
+// Nibbled keys along with their nodes encoded for storage, as collected
+    class CollectedNodes {
+    public:
+        void append(ByteView nibbled_key, const Node &node);
+
+        [[nodiscard]] size_t size() const noexcept { return nodes_.size(); }
+
+        [[nodiscard]] bool empty() const noexcept { return nodes_.empty(); }
+
+        [[nodiscard]] ByteView key(size_t i) const noexcept {
+            return ByteView{keys_}.substr(key_offsets_[i], key_offsets_[i + 1] - key_offsets_[i]);
+        }
+
+        //! \brief The i-th node, encoded for storage
+        [[nodiscard]] ByteView node(size_t i) const noexcept { return nodes_[i]; }
+
+        [[nodiscard]] const EncodedNodes &nodes() const noexcept { return nodes_; }
+
+        //! \brief Empties the batch, keeping its memory for the next one
+        void clear();
+
+    private:
+        Bytes keys_;
+        std::vector<size_t> key_offsets_{0};
+        EncodedNodes nodes_;
+    };
+
+// Node collector persisting the nodes on a background thread, so that HashBuilder never waits on I/O.
+// Nodes are appended to the batch at the head of a ring of reusable batches; full batches are handed over
+// to the writer thread through a lock-free single-producer single-consumer queue. Once all the batches are
+// in flight, collecting waits for the writer (back pressure), which bounds the memory used.
+    class AsyncNodeSink {
+    public:
+        //! \brief Persists a batch, e.g. as a single DB transaction; called on the writer thread only
+        using BatchWriter = std::function<void(const CollectedNodes &)>;
+
+        //! \param [in] writer : persists the batches, in the order collected
+        //! \param [in] batch_size : nodes per batch handed to writer
+        //! \param [in] num_batches : batches of the ring, i.e. up to num_batches - 1 may await the writer
+        explicit AsyncNodeSink(BatchWriter writer, size_t batch_size = 4096, size_t num_batches = 4);
+
+        // Not copyable nor movable, since the writer thread refers to it
+        AsyncNodeSink(const AsyncNodeSink &) = delete;
+
+        AsyncNodeSink &operator=(const AsyncNodeSink &) = delete;
+
+        //! \brief Writes the nodes left, then joins the writer thread
+        //! \remarks Errors of the writer are dropped; call flush beforehand to get them
+        ~AsyncNodeSink();
+
+        //! \brief Collects a node, to be persisted later on
+        //! \throws The exception thrown by the writer, if any: once it has failed, nothing is collected anymore
+        void operator()(ByteView nibbled_key, const Node &node);
+
+        //! \brief Collector to be set as the node_collector of a HashBuilder, referring to this sink
+        [[nodiscard]] NodeCollector collector() {
+            return [this](ByteView nibbled_key, const Node &node) { (*this)(nibbled_key, node); };
+        }
+
+        //! \brief Hands over the current batch, however small, and waits until all the batches are written
+        //! \throws The exception thrown by the writer, if any
+        void flush();
+
+        //! \brief Batches handed over and not written yet
+        [[nodiscard]] size_t pending_batches() const noexcept {
+            return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+        }
+
+        //! \brief How many times collecting had to wait for the writer, as all the batches were in flight
+        [[nodiscard]] size_t stalls() const noexcept { return stalls_; }
+
+    private:
+        // Hands over the batch at the head, waiting for a free one to become the head
+        void publish();
+
+        void rethrow_if_failed();
+
+        void write_loop();
+
+        BatchWriter writer_;
+        size_t batch_size_;
+        std::vector<CollectedNodes> ring_;
+
+        // Batches [tail_, head_) are handed over, ring_[head_ % size] is being filled
+        std::atomic<size_t> head_{0};
+        std::atomic<size_t> tail_{0};
+        std::atomic<uint32_t> wakeups_{0};  // bumped on each hand-over and on stop, for the writer to wait on
+        std::atomic<bool> stopping_{false};
+        std::atomic<bool> failed_{false};
+        std::exception_ptr error_;  // set by the writer thread before failed_
+        size_t stalls_{0};
+
+        std::thread thread_;  // last, started once the members above are
+    };
+
+}  // namespace silkworm::trie
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct silkworm_AsyncNodeSink silkworm_AsyncNodeSink;
+
+// Receives count nibbled keys along with their nodes encoded for storage, on the writer thread
+typedef void (*silkworm_NodeBatchWriter)(void *context, const silkworm_ByteView *nibbled_keys,
+                                         const silkworm_ByteView *nodes, size_t count);
+
+silkworm_AsyncNodeSink *silkworm_AsyncNodeSink_new(silkworm_NodeBatchWriter writer, void *context,
+                                                   size_t batch_size, size_t num_batches);
+void silkworm_AsyncNodeSink_free(silkworm_AsyncNodeSink *sink);
+
+// Sets the sink as the node collector of the builder; the sink must outlive it
+void silkworm_AsyncNodeSink_attach(silkworm_AsyncNodeSink *sink, silkworm_HashBuilder *builder);
+
+void silkworm_AsyncNodeSink_flush(silkworm_AsyncNodeSink *sink);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILKWORM_TRIE_ASYNC_NODE_SINK_HPP
@@ -0,0 +1,114 @@
+#ifndef SILKWORM_TRIE_ETL_HASH_BUILDER_HPP
+#define SILKWORM_TRIE_ETL_HASH_BUILDER_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+#include "hash_builder.hpp"
+
+#ifdef __cplusplus
+
+#include <filesystem>
+#include <vector>
+
+#include "merkle-patricia-tree/common/thread_pool.hpp"
+
+namespace silkworm::trie {
+
+// Calculates the same root hash as HashBuilder from leaves added in any order, in bounded memory however many
+// there are. Following Silkworm's ETL (extract, transform, load) collector, leaves are buffered up to a budget,
+// then the buffer is radix sorted and spilled into a temporary file as a sorted run. The root is calculated by
+// a k-way merge of the runs streamed into HashBuilder, so that the full set of leaves is never materialized.
+// Should there be more runs than can be opened at once, groups of them are first merged into longer runs.
+    class EtlHashBuilder {
+    public:
+        static constexpr size_t kDefaultBufferSize{256u << 20};
+
+        // Well below the usual limit of 1024 open files, e.g. 300 GB of leaves in runs of 256 MiB take 2 passes
+        static constexpr size_t kDefaultMaxMergeWidth{256};
+
+        //! \param [in] work_dir : directory of the run files; empty means the temporary directory of the system
+        //! \param [in] buffer_size : bytes of leaves buffered before being spilled, their index and the memory
+        //! to sort them included; also bounds the read buffers of the merge
+        //! \param [in] pool : workers sorting the buffer; nullptr means the calling thread only
+        //! \param [in] max_merge_width : runs merged at once, hence open at once; at least 2
+        explicit EtlHashBuilder(std::filesystem::path work_dir = {}, size_t buffer_size = kDefaultBufferSize,
+                                ThreadPool *pool = nullptr, size_t max_merge_width = kDefaultMaxMergeWidth);
+
+        // Not copyable nor movable, since it owns its run files
+        EtlHashBuilder(const EtlHashBuilder &) = delete;
+
+        EtlHashBuilder &operator=(const EtlHashBuilder &) = delete;
+
+        //! \brief Removes the run files left, if any
+        ~EtlHashBuilder();
+
+        //! \brief Receives the nodes of the trie while root_hash merges the runs, as with HashBuilder
+        NodeCollector node_collector{nullptr};
+
+        //! \brief Adds a leaf, in any order
+        //! \param [in] key : packed key, e.g. a hashed one; the usual HashBuilder constraints apply to the whole set
+        //! \param [in] value : already RLP-encoded, non-empty
+        //! \throws std::runtime_error if a run can't be written
+        void add_leaf(ByteView key, ByteView value);
+
+        //! \brief Merges all the leaves added so far into the root hash, which empties the builder
+        //! \remarks Leaves that never left the buffer are not written at all
+        //! \throws std::runtime_error if a run can't be read
+        evmc::bytes32 root_hash();
+
+        //! \brief Number of runs spilled since the builder was emptied
+        [[nodiscard]] size_t num_runs() const noexcept { return runs_.size(); }
+
+        //! \brief Drops the leaves added so far along with their run files
+        void reset();
+
+    private:
+        // Location of a leaf in buffer_
+        struct Entry {
+            size_t offset;
+            uint32_t key_length;
+            uint32_t value_length;
+        };
+
+        [[nodiscard]] std::vector<std::pair<ByteView, ByteView>> sorted_buffer();
+
+        [[nodiscard]] std::filesystem::path next_run_path();
+
+        [[nodiscard]] size_t read_buffer_size(size_t num_runs) const noexcept;
+
+        void spill();
+
+        std::filesystem::path work_dir_;
+        size_t buffer_size_;
+        ThreadPool *pool_;
+        size_t max_merge_width_;
+
+        Bytes buffer_;
+        std::vector<Entry> entries_;
+        std::vector<std::filesystem::path> runs_;
+        uint64_t file_prefix_;
+        uint64_t file_counter_{0};
+    };
+
+}  // namespace silkworm::trie
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct silkworm_EtlHashBuilder silkworm_EtlHashBuilder;
+
+// A NULL or empty work_dir means the temporary directory of the system; 0 for buffer_size means the default
+silkworm_EtlHashBuilder *silkworm_EtlHashBuilder_new(const char *work_dir, size_t buffer_size);
+void silkworm_EtlHashBuilder_free(silkworm_EtlHashBuilder *builder);
+
+// Return non-zero on success, zero on an I/O error
+int silkworm_EtlHashBuilder_add_leaf(silkworm_EtlHashBuilder *builder, silkworm_ByteView key, silkworm_ByteView value);
+int silkworm_EtlHashBuilder_root_hash(silkworm_EtlHashBuilder *builder, uint8_t out_hash[32]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILKWORM_TRIE_ETL_HASH_BUILDER_HPP
@@ -19,12 +19,19 @@
 
 #include "merkle-patricia-tree/common/base.hpp"
 #include "merkle-patricia-tree/common/bytes.hpp"
+#include "merkle-patricia-tree/common/keccak_sponge.hpp"
+#include "nibbles.hpp"
 #include "node.hpp"
+#include "node_ref.hpp"
+#include "proof_retainer.hpp"
 
 #ifdef __cplusplus
 
+#include <array>
 #include <functional>
 #include <optional>
+#include <span>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
@@ -33,17 +40,66 @@ namespace silkworm::trie {
 // Erigon HashCollector2
     using NodeCollector = std::function<void(ByteView nibbled_key, const Node &)>;
 
+// Receives a node built by HashBuilder as a whole: the path to it from the root, its RLP and its reference
+// (its hash if the RLP is 32 bytes or longer, the RLP itself otherwise)
+    using NodeRlpCollector = std::function<void(PackedNibbles path, ByteView rlp, const NodeRef &ref)>;
+
+// Collector policy of a HashBuilderT that only computes the root, e.g. of receipts or transactions
+    struct NoCollector {
+    };
+
+// Stack of node masks of bounded depth, standing in for std::vector<uint16_t> without any allocation
+    template<size_t kMaxDepth>
+    class FixedMaskStack {
+    public:
+        [[nodiscard]] size_t size() const noexcept { return size_; }
+
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+        uint16_t &operator[](size_t i) noexcept { return masks_[i]; }
+
+        uint16_t operator[](size_t i) const noexcept { return masks_[i]; }
+
+        uint16_t back() const noexcept { return masks_[size_ - 1]; }
+
+        void pop_back() noexcept { --size_; }
+
+        //! \brief Same as std::vector::resize, new masks being zero
+        void resize(size_t size) noexcept {
+            for (size_t i{size_}; i < size; ++i) {
+                masks_[i] = 0;
+            }
+            size_ = size;
+        }
+
+        void clear() noexcept { size_ = 0; }
+
+    private:
+        std::array<uint16_t, kMaxDepth> masks_{};
+        size_t size_{0};
+    };
+
 // Calculates root hash of a Modified Merkle Patricia Trie.
 // See Appendix D "Modified Merkle Patricia Trie" of the Yellow Paper
 // and https://eth.wiki/fundamentals/patricia-tree
-    class HashBuilder {
+//
+// Nodes are passed to a Collector invocable as void(ByteView nibbled_key, const Node &), known at compile time
+// so that it can be inlined. With NoCollector, the bookkeeping of the masks of the nodes is compiled out.
+//
+// If kKeyNibbles isn't 0, all the leaves have keys of that many nibbles, e.g. 64 for keccak-hashed keys,
+// allowing for masks of fixed depth and word-wise comparisons of keys.
+//
+// Member definitions are in hash_builder_impl.hpp; HashBuilderT is instantiated for NodeCollector and NoCollector,
+// with keys of either any length or 64 nibbles.
+    template<class Collector, size_t kKeyNibbles = 0>
+    class HashBuilderT {
     public:
-        HashBuilder() = default;
+        HashBuilderT() = default;
 
         // Not copyable nor movable
-        HashBuilder(const HashBuilder &) = delete;
+        HashBuilderT(const HashBuilderT &) = delete;
 
-        HashBuilder &operator=(const HashBuilder &) = delete;
+        HashBuilderT &operator=(const HashBuilderT &) = delete;
 
         //! \details Entries (leaves, nodes) must be added in the strictly increasing lexicographic order (by key).
         //! Consequently, duplicate keys are not allowed.
@@ -52,6 +108,15 @@ namespace silkworm::trie {
         //! (e.g. leaves with keys 0a0b & 0a0b0005 may not coexist).
         void add_leaf(Bytes nibbled_key, ByteView value);
 
+        //! \brief Same as above with the key packed two nibbles per byte, e.g. a hashed key as is
+        //! \remarks Spares unpacking the key, which is copied into the builder
+        void add_leaf(PackedNibbles key, ByteView value);
+
+        //! \brief Same as above without copying the key nor the value, e.g. when they come from a memory-mapped file
+        //! \attention Both key and value must stay valid until the next call to add_leaf, add_leaf_borrowed,
+        //! add_branch_node, root_hash, root_node_ref or reset returns, since they are only consumed by that call
+        void add_leaf_borrowed(PackedNibbles key, ByteView value);
+
         //! \details Entries (leaves, nodes) must be added in the strictly increasing lexicographic order (by key).
         //! Consequently, duplicate keys are not allowed.
         //! The key should be unpacked, i.e. have one nibble per byte.
@@ -62,38 +127,143 @@ namespace silkworm::trie {
         //! \remarks If no entries in the stack_ the kEmptyRoot is returned
         evmc::bytes32 root_hash();
 
-        //! \brief Pointer to function for collecting nodes in etl.
-        NodeCollector node_collector{nullptr};
+        //! \brief Returns the reference to the root node computed on behalf of added entries:
+        //! its RLP if shorter than 32 bytes, otherwise its RLP-wrapped hash
+        //! \remarks If no entries in the stack_ an empty reference is returned
+        NodeRef root_node_ref();
+
+        //! \brief Sink of the nodes to be stored in the DB trie, e.g. in etl
+        //! \remarks Nodes aren't collected if it converts to false
+        [[no_unique_address]] Collector node_collector{};
+
+        //! \brief If set, retains the nodes on the paths to its targets while the root hash is computed
+        //! \remarks Must be set before the first entry is added
+        std::optional<ProofRetainer> proof_retainer;
+
+        //! \brief If set, receives every node built, leaves and extensions included, children before parents,
+        //! e.g. to bulk-load a store of nodes by hash serving proofs
+        //! \remarks Unlike node_collector it sees whole nodes, hence their RLP is built rather than hashed
+        //! on the fly. Nodes added by add_branch_node aren't built, thus not reported.
+        NodeRlpCollector rlp_collector{nullptr};
 
         //! \brief Resets the builder as newly created
         void reset();
 
+        //! \brief Bytes of leaf keys (packed) and values copied into the builder by add_leaf since it was reset,
+        //! i.e. spared by add_leaf_borrowed
+        [[nodiscard]] size_t bytes_copied() const noexcept { return bytes_copied_; }
+
+        //! \brief Serializes the state of the computation, so that it can be resumed by load_checkpoint,
+        //! e.g. after a restart, once the entries added so far and the nodes collected are persisted
+        //! \remarks Holds the pending entry, borrowed or not, the prefix groups, the masks and the stack of
+        //! node references, i.e. O(depth) bytes. Collectors and the nodes retained for proofs aren't part of it.
+        [[nodiscard]] Bytes save_checkpoint() const;
+
+        //! \brief Restores the state serialized by save_checkpoint, entries being then added from where it was saved
+        //! \remarks Collectors and proof_retainer are left as they are. The builder is unchanged on error.
+        DecodingResult load_checkpoint(ByteView checkpoint);
+
     private:
+        static constexpr bool kCollects{!std::is_same_v<Collector, NoCollector>};
+        static constexpr bool kFixedLength{kKeyNibbles != 0};
+        static_assert(kKeyNibbles % 16 == 0, "fixed-length keys are compared by 64-bit words");
+
+        using MaskStack = std::conditional_t<kFixedLength, FixedMaskStack<kKeyNibbles + 1>, std::vector<uint16_t>>;
+
+        // Same as PackedNibbles operator< and prefix_length, word-wise for fixed-length keys
+        static bool key_less(PackedNibbles a, PackedNibbles b) noexcept;
+
+        static size_t key_prefix_length(PackedNibbles a, PackedNibbles b) noexcept;
+
+        [[nodiscard]] bool collecting() const noexcept {
+            if constexpr (std::is_constructible_v<bool, const Collector &>) {
+                return static_cast<bool>(node_collector);
+            } else {
+                return kCollects;
+            }
+        }
+
         evmc::bytes32 root_hash(bool auto_finalize);
 
         void finalize();
 
+        // Packs an unpacked key into next_key_
+        PackedNibbles pack_next_key(ByteView nibbled_key);
+
+        // Processes the current key now that the following one is known
+        void advance(PackedNibbles key);
+
+        // Makes value_ view a copy of the leaf value
+        void copy_value(ByteView value);
+
         // See Erigon GenStructStep
-        void gen_struct_step(ByteView current, ByteView succeeding);
+        void gen_struct_step(PackedNibbles current, PackedNibbles succeeding);
 
-        std::vector<Bytes> branch_ref(uint16_t state_mask, uint16_t hash_mask);
+        // The branch node lies at path; the hashes of the children in hash_mask are copied into child_hashes_
+        // beforehand, and their number returned
+        size_t branch_ref(uint16_t state_mask, uint16_t hash_mask, PackedNibbles path);
 
-        ByteView leaf_node_rlp(ByteView path, ByteView value);
+        // Fast path of branch_ref when all the children are hashes
+        void push_hash_branch_node(uint16_t state_mask, size_t first_child_idx, PackedNibbles path);
 
-        ByteView extension_node_rlp(ByteView path, ByteView child_ref);
+        // Replaces the num_children topmost stack items with the reference to their parent node at path,
+        // whose RLP payload is passed piece by piece by write_payload to the function it's called with.
+        // Unless the node gets embedded or retained for a proof, its RLP is hashed straight from the pieces.
+        template<class WritePayload>
+        void push_node(PackedNibbles path, size_t payload_length, size_t num_children, WritePayload &&write_payload);
 
-        Bytes key_;                                 // unpacked – one nibble per byte
-        std::variant<Bytes, evmc::bytes32> value_;  // leaf value or node hash
-        bool is_in_db_trie_{false};
+        // The path of a short node spans the key from the nibble at path_begin
+        void push_leaf_node(PackedNibbles key, size_t path_begin, ByteView value);
+
+        // The child is the topmost stack item
+        void push_extension_node(PackedNibbles key, size_t path_begin);
 
-        std::vector<uint16_t> groups_;
-        std::vector<uint16_t> tree_masks_;
-        std::vector<uint16_t> hash_masks_;
-        std::vector<Bytes> stack_;  // node references: hashes or embedded RLPs
+        void push_hash(std::span<const uint8_t, kHashLength> hash);
 
-        Bytes rlp_buffer_;
+        // Pushes either the RLP itself, if shorter than 32 bytes, or its RLP-wrapped hash
+        void push_node_ref(ByteView rlp);
+
+        void pop_stack(size_t count);
+
+        // Views of either borrowed data or the buffers below
+        PackedNibbles key_;
+        std::variant<ByteView, evmc::bytes32> value_;  // leaf value or node hash
+        bool is_in_db_trie_{false};
+
+        MaskStack groups_;
+        MaskStack tree_masks_;  // unused with NoCollector
+        MaskStack hash_masks_;  // unused with NoCollector
+
+        // Node references (hashes or embedded RLPs), held inline so that no allocation happens
+        // once the stack has grown to the maximum depth of the trie
+        std::vector<NodeRef> stack_;
+        std::array<evmc::bytes32, 16> child_hashes_;  // hashes of the children of a collected branch node
+
+        KeccakSponge sponge_;
+        std::array<uint8_t, 532> branch_buffer_;  // RLP of a branch node with 16 hashes, the longest one
+        Bytes rlp_buffer_;            // RLP of an embedded or retained node
+        Bytes header_buffer_;         // RLP header of a node
+        Bytes string_header_buffer_;  // RLP headers of the strings within a short node
+        Bytes path_buffer_;           // compact encoding of a node path
+        Bytes key_buffer_;            // copy of the current key, packed
+        Bytes next_key_;              // unpacked key being added, once packed
+        Bytes value_buffer_;          // copy of the current leaf value
+        Bytes collected_key_;         // unpacked key of a collected node
+
+        size_t bytes_copied_{0};
     };
 
+    using HashBuilder = HashBuilderT<NodeCollector>;
+
+//! \brief HashBuilder of keccak-hashed keys, i.e. 64 nibbles long
+    template<class Collector = NodeCollector>
+    using HashedKeyHashBuilder = HashBuilderT<Collector, 2 * kHashLength>;
+
+    extern template class HashBuilderT<NodeCollector>;
+    extern template class HashBuilderT<NoCollector>;
+    extern template class HashBuilderT<NodeCollector, 2 * kHashLength>;
+    extern template class HashBuilderT<NoCollector, 2 * kHashLength>;
+
 }  // namespace silkworm::trie
 #endif
 
@@ -110,6 +280,10 @@ void silkworm_HashBuilder_free(silkworm_HashBuilder *builder);
 // Добавление листа
 void silkworm_HashBuilder_add_leaf(silkworm_HashBuilder *builder, silkworm_Bytes nibbled_key, silkworm_ByteView value);
 
+// Добавление листа с упакованным ключом (два полубайта на байт)
+void silkworm_HashBuilder_add_packed_leaf(silkworm_HashBuilder *builder, silkworm_ByteView packed_key, int odd_length,
+                                          silkworm_ByteView value);
+
 // Добавление ветви
 void
 silkworm_HashBuilder_add_branch_node(silkworm_HashBuilder *builder, silkworm_Bytes nibbled_key, const uint8_t hash[32],
@@ -125,6 +299,17 @@ void silkworm_HashBuilder_reset(silkworm_HashBuilder *builder);
 typedef void (*silkworm_NodeCollector)(silkworm_ByteView nibbled_key, const void *node);
 void silkworm_HashBuilder_set_node_collector(silkworm_HashBuilder *builder, silkworm_NodeCollector collector);
 
+// Checkpoints of the state of the builder; see HashBuilderT::save_checkpoint
+silkworm_Bytes silkworm_HashBuilder_save_checkpoint(const silkworm_HashBuilder *builder);
+silkworm_DecodingResult silkworm_HashBuilder_load_checkpoint(silkworm_HashBuilder *builder,
+                                                             silkworm_ByteView checkpoint);
+
+// Receives every node built along with its nibbled path and its reference; see HashBuilderT::rlp_collector
+typedef void (*silkworm_NodeRlpCollector)(void *context, silkworm_ByteView nibbled_path, silkworm_ByteView rlp,
+                                          silkworm_ByteView ref);
+void silkworm_HashBuilder_set_rlp_collector(silkworm_HashBuilder *builder, silkworm_NodeRlpCollector collector,
+                                            void *context);
+
 #ifdef __cplusplus
 }
 #endif
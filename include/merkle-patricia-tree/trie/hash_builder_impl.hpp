@@ -0,0 +1,690 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKWORM_TRIE_HASH_BUILDER_IMPL_HPP
+#define SILKWORM_TRIE_HASH_BUILDER_IMPL_HPP
+
+// Definitions of HashBuilderT members.
+// Only needed to instantiate HashBuilderT with a collector other than NodeCollector or NoCollector.
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iterator>
+
+#include <ethash/keccak.hpp>
+
+#include "merkle-patricia-tree/common/assert.hpp"
+#include "merkle-patricia-tree/common/empty_hashes.hpp"
+#include "merkle-patricia-tree/common/endian.hpp"
+#include "merkle-patricia-tree/common/util.hpp"
+#include "merkle-patricia-tree/rlp/encode.hpp"
+#include "hash_builder.hpp"
+
+namespace silkworm::trie {
+
+
+// See "Specification: Compact encoding of hex sequence with optional terminator"
+// at https://eth.wiki/fundamentals/patricia-tree
+    inline void encode_path(Bytes &out, PackedNibbles key, size_t begin, bool terminating) {
+        const size_t len{key.length() - begin};
+        out.resize(len / 2 + 1);
+        const bool odd{static_cast<bool>((len & 1u) != 0)};
+
+        out[0] = terminating ? 0x20 : 0x00;
+        out[0] += odd ? 0x10 : 0x00;
+
+        if (odd) {
+            out[0] |= key[begin];
+            ++begin;
+        }
+
+        if ((begin & 1u) == 0) {
+            // The remaining nibbles are already packed as required
+            if (out.length() > 1) {
+                std::memcpy(&out[1], &key.data[begin / 2], out.length() - 1);
+            }
+        } else {
+            for (auto it{std::next(out.begin(), 1)}, end{out.end()}; it != end; ++it) {
+                *it = static_cast<uint8_t>((key[begin] << 4) + key[begin + 1]);
+                begin += 2;
+            }
+        }
+    }
+
+// RLP of an empty child of a branch node
+    inline constexpr uint8_t kEmptyStringRlp[]{rlp::kEmptyStringCode};
+
+// Header of the RLP of a string, e.g. an encoded path or a leaf value
+    inline void encode_string_header(Bytes &out, ByteView str) {
+        if (str.length() != 1 || str[0] >= rlp::kEmptyStringCode) {
+            rlp::encode_header(out, {.list = false, .payload_length = str.length()});
+        }
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    template<class WritePayload>
+    void HashBuilderT<Collector, kKeyNibbles>::push_node(PackedNibbles path, size_t payload_length,
+                                                         size_t num_children, WritePayload &&write_payload) {
+        header_buffer_.clear();
+        rlp::encode_header(header_buffer_, {.list = true, .payload_length = payload_length});
+
+        const bool retained{proof_retainer && proof_retainer->on_target_path(path)};
+        if (retained || rlp_collector || header_buffer_.length() + payload_length < kHashLength) {
+            // Embedded node, or one whose RLP is needed as a whole
+            rlp_buffer_.assign(header_buffer_);
+            write_payload([this](ByteView piece) { rlp_buffer_.append(piece); });
+            pop_stack(num_children);
+            push_node_ref(rlp_buffer_);
+            if (retained) {
+                proof_retainer->retain(path, rlp_buffer_);
+            }
+            if (rlp_collector) {
+                rlp_collector(path, rlp_buffer_, stack_.back());
+            }
+            return;
+        }
+
+        sponge_.absorb(header_buffer_);
+        write_payload([this](ByteView piece) { sponge_.absorb(piece); });
+        const ethash::hash256 hash{sponge_.finalize()};
+        pop_stack(num_children);
+        push_hash(hash.bytes);
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::push_leaf_node(PackedNibbles key, size_t path_begin, ByteView value) {
+        encode_path(path_buffer_, key, path_begin, /*terminating=*/true);
+        string_header_buffer_.clear();
+        encode_string_header(string_header_buffer_, path_buffer_);
+        const size_t path_header_length{string_header_buffer_.length()};
+        encode_string_header(string_header_buffer_, value);
+
+        const size_t payload_length{string_header_buffer_.length() + path_buffer_.length() + value.length()};
+        push_node(key.prefix(path_begin), payload_length, /*num_children=*/0, [&](auto &&write) {
+            const ByteView headers{string_header_buffer_};
+            write(headers.substr(0, path_header_length));
+            write(path_buffer_);
+            write(headers.substr(path_header_length));
+            write(value);
+        });
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::push_extension_node(PackedNibbles key, size_t path_begin) {
+        encode_path(path_buffer_, key, path_begin, /*terminating=*/false);
+        string_header_buffer_.clear();
+        encode_string_header(string_header_buffer_, path_buffer_);
+
+        const ByteView child_ref{stack_.back()};
+        const size_t payload_length{string_header_buffer_.length() + path_buffer_.length() + child_ref.length()};
+        push_node(key.prefix(path_begin), payload_length, /*num_children=*/1, [&](auto &&write) {
+            write(string_header_buffer_);
+            write(path_buffer_);
+            write(child_ref);
+        });
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::push_hash(std::span<const uint8_t, kHashLength> hash) {
+        stack_.push_back(NodeRef::from_hash(hash));
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::push_node_ref(ByteView rlp) {
+        stack_.push_back(NodeRef::from_rlp(rlp));
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::pop_stack(size_t count) {
+        stack_.resize(stack_.size() - count);
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    PackedNibbles HashBuilderT<Collector, kKeyNibbles>::pack_next_key(ByteView nibbled_key) {
+        next_key_.resize((nibbled_key.length() + 1) / 2);
+        for (size_t i{0}; i < nibbled_key.length(); i += 2) {
+            const uint8_t low{i + 1 < nibbled_key.length() ? nibbled_key[i + 1] : uint8_t{0}};
+            next_key_[i / 2] = static_cast<uint8_t>((nibbled_key[i] << 4) + low);
+        }
+        return PackedNibbles{next_key_, (nibbled_key.length() & 1u) != 0};
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    bool HashBuilderT<Collector, kKeyNibbles>::key_less(PackedNibbles a, PackedNibbles b) noexcept {
+        if constexpr (kFixedLength) {
+            if (a.length() == kKeyNibbles && b.length() == kKeyNibbles) {
+                return std::memcmp(a.data.data(), b.data.data(), kKeyNibbles / 2) < 0;
+            }
+        }
+        return a < b;
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    size_t HashBuilderT<Collector, kKeyNibbles>::key_prefix_length(PackedNibbles a, PackedNibbles b) noexcept {
+        if constexpr (kFixedLength) {
+            if (a.length() == kKeyNibbles && b.length() == kKeyNibbles) {
+                for (size_t i{0}; i < kKeyNibbles / 2; i += 8) {
+                    const uint64_t diff{endian::load_big_u64(&a.data[i]) ^ endian::load_big_u64(&b.data[i])};
+                    if (diff) {
+                        return i * 2 + static_cast<size_t>(std::countl_zero(diff)) / 4;
+                    }
+                }
+                return kKeyNibbles;
+            }
+        }
+        return prefix_length(a, b);
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::advance(PackedNibbles key) {
+        if constexpr (kFixedLength) {
+            SILKWORM_ASSERT(key.length() == kKeyNibbles);
+        }
+        SILKWORM_ASSERT(key_less(key_, key));
+        if (!key_.empty()) {
+            gen_struct_step(key_, key);
+        }
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::copy_value(ByteView value) {
+        value_buffer_.assign(value);  // reuse the allocated capacity
+        value_ = ByteView{value_buffer_};
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::add_leaf(Bytes nibbled_key, ByteView value) {
+        const PackedNibbles key{pack_next_key(nibbled_key)};
+        advance(key);
+        key_buffer_.swap(next_key_);
+        key_ = PackedNibbles{key_buffer_, key.odd};
+        copy_value(value);
+        bytes_copied_ += key_buffer_.length() + value.length();
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::add_leaf(PackedNibbles key, ByteView value) {
+        advance(key);
+        key_buffer_.assign(key.data);
+        key_ = PackedNibbles{key_buffer_, key.odd};
+        copy_value(value);
+        bytes_copied_ += key.data.length() + value.length();
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::add_leaf_borrowed(PackedNibbles key, ByteView value) {
+        advance(key);
+        key_ = key;
+        value_ = value;
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::add_branch_node(Bytes nibbled_key, const evmc::bytes32 &hash, bool is_in_db_trie) {
+        const PackedNibbles key{pack_next_key(nibbled_key)};
+        if constexpr (kFixedLength) {
+            SILKWORM_ASSERT(key.length() <= kKeyNibbles);
+        }
+        SILKWORM_ASSERT(key_less(key_, key) || (key_.empty() && key.empty()));
+        if (!key_.empty()) {
+            gen_struct_step(key_, key);
+        } else if (key.empty()) {
+            // known root hash
+            push_hash(hash.bytes);
+        }
+        key_buffer_.swap(next_key_);
+        key_ = PackedNibbles{key_buffer_, key.odd};
+        value_ = hash;
+        is_in_db_trie_ = is_in_db_trie;
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::finalize() {
+        if (!key_.empty()) {
+            gen_struct_step(key_, PackedNibbles{});
+            key_ = PackedNibbles{};
+            value_ = ByteView{};
+        }
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    evmc::bytes32 HashBuilderT<Collector, kKeyNibbles>::root_hash() { return root_hash(/*auto_finalize=*/true); }
+
+    template<class Collector, size_t kKeyNibbles>
+    NodeRef HashBuilderT<Collector, kKeyNibbles>::root_node_ref() {
+        finalize();
+        return stack_.empty() ? NodeRef{} : stack_.back();
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    evmc::bytes32 HashBuilderT<Collector, kKeyNibbles>::root_hash(bool auto_finalize) {
+        if (auto_finalize) {
+            finalize();
+        }
+
+        if (stack_.empty()) {
+            return kEmptyRoot;
+        }
+        return stack_.back().node_hash();
+    }
+
+// https://github.com/ledgerwatch/erigon/blob/devel/docs/programmers_guide/guide.md#generating-the-structural-information-from-the-sequence-of-keys
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::gen_struct_step(PackedNibbles current, const PackedNibbles succeeding) {
+        for (bool build_extensions{false};; build_extensions = true) {
+            const bool preceding_exists{!groups_.empty()};
+
+            // Calculate the prefix of the smallest prefix group containing current
+            const size_t preceding_len{groups_.empty() ? 0 : groups_.size() - 1};
+            const size_t common_prefix_len{key_prefix_length(succeeding, current)};
+            const size_t len{std::max(preceding_len, common_prefix_len)};
+            SILKWORM_ASSERT(len < current.length());
+
+            // Add the digit immediately following the max common prefix
+            const uint8_t extra_digit{current[len]};
+            if (groups_.size() <= len) {
+                groups_.resize(len + 1);
+            }
+            groups_[len] |= 1u << extra_digit;
+
+            if constexpr (kCollects) {
+                if (tree_masks_.size() < current.length()) {
+                    tree_masks_.resize(current.length());
+                    hash_masks_.resize(current.length());
+                }
+            }
+
+            size_t from{len};
+            if (!succeeding.empty() || preceding_exists) {
+                ++from;
+            }
+
+            const size_t short_node_key_len{current.length() - from};
+            if (!build_extensions) {
+                if (const ByteView *leaf_value{std::get_if<ByteView>(&value_)}) {
+                    push_leaf_node(current, from, *leaf_value);
+                } else {
+                    push_hash(std::get<evmc::bytes32>(value_).bytes);
+                    if constexpr (kCollects) {
+                        if (collecting()) {
+                            if (is_in_db_trie_) {
+                                // keep track of existing records in DB
+                                tree_masks_[current.length() - 1] |= 1u << current[current.length() - 1];
+                            }
+                            // register myself in parent's bitmaps
+                            hash_masks_[current.length() - 1] |= 1u << current[current.length() - 1];
+                        }
+                    }
+                    build_extensions = true;
+                }
+            }
+
+            if (build_extensions && short_node_key_len > 0) {  // extension node
+                if constexpr (kCollects) {
+                    if (collecting() && from > 0) {
+                        // See node/silkworm/trie/intermediate_hashes.hpp
+                        const auto flag{static_cast<uint16_t>(1u << current[from - 1])};
+
+                        // DB trie can't use hash of an extension node
+                        hash_masks_[from - 1] &= ~flag;
+
+                        if (tree_masks_[current.length() - 1]) {
+                            // Propagate tree_masks flag along the extension node
+                            tree_masks_[from - 1] |= flag;
+                        }
+                    }
+                }
+
+                push_extension_node(current, from);
+
+                if constexpr (kCollects) {
+                    hash_masks_.resize(from);
+                    tree_masks_.resize(from);
+                }
+            }
+
+            // Check for the optional part
+            if (preceding_len <= common_prefix_len && !succeeding.empty()) {
+                return;
+            }
+
+            // Close the immediately encompassing prefix group, if needed
+            if (!succeeding.empty() || preceding_exists) {  // branch node
+                if constexpr (!kCollects) {
+                    branch_ref(groups_[len], /*hash_mask=*/0, current.prefix(len));
+                } else {
+                    const size_t num_hashes{branch_ref(groups_[len], hash_masks_[len], current.prefix(len))};
+
+                    // See node/silkworm/trie/intermediate_hashes.hpp
+                    if (collecting()) {
+                        if (len > 0) {
+                            hash_masks_[len - 1] |= 1u << current[len - 1];
+                        }
+
+                        const bool store_in_db_trie{tree_masks_[len] || hash_masks_[len]};
+                        if (store_in_db_trie) {
+                            if (len > 0) {
+                                tree_masks_[len - 1] |= 1u << current[len - 1];  // register myself in parent bitmap
+                            }
+
+                            Node node{groups_[len], tree_masks_[len], hash_masks_[len],
+                                      std::span{child_hashes_.data(), num_hashes}};
+                            if (len == 0) {
+                                node.set_root_hash(root_hash(/*auto_finalize=*/false));
+                            }
+
+                            collected_key_.resize(len);
+                            for (size_t i{0}; i < len; ++i) {
+                                collected_key_[i] = current[i];
+                            }
+                            node_collector(ByteView{collected_key_}, node);
+                        }
+                    }
+                }
+            }
+
+            groups_.resize(len);
+            if constexpr (kCollects) {
+                tree_masks_.resize(len);
+                hash_masks_.resize(len);
+            }
+
+            if (preceding_len == 0) {
+                return;
+            }
+
+            // Update current key for the build_extensions iteration
+            current = current.prefix(preceding_len);
+            while (!groups_.empty() && groups_.back() == 0) {
+                groups_.pop_back();
+            }
+        }
+    }
+
+// Takes children from the stack and replaces them with branch node ref.
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::push_hash_branch_node(uint16_t state_mask, size_t first_child_idx,
+                                                                     PackedNibbles path) {
+        // A wrapped hash per child plus an empty string per missing child & the nil value
+        const size_t payload_length{17 + kHashLength * static_cast<size_t>(std::popcount(state_mask))};
+
+        uint8_t *out{branch_buffer_.data()};
+        if (payload_length < 56) {  // a single child
+            *out++ = static_cast<uint8_t>(rlp::kEmptyListCode + payload_length);
+        } else if (payload_length < 256) {
+            *out++ = rlp::kEmptyListCode + 56;
+            *out++ = static_cast<uint8_t>(payload_length);
+        } else {
+            *out++ = rlp::kEmptyListCode + 57;
+            *out++ = static_cast<uint8_t>(payload_length >> 8);
+            *out++ = static_cast<uint8_t>(payload_length);
+        }
+
+        const NodeRef *child{&stack_[first_child_idx]};
+        for (size_t digit{0}; digit < 16; ++digit) {
+            if (state_mask & (1u << digit)) {
+                std::memcpy(out, (child++)->data(), kHashLength + 1);
+                out += kHashLength + 1;
+            } else {
+                *out++ = rlp::kEmptyStringCode;
+            }
+        }
+        *out++ = rlp::kEmptyStringCode;
+
+        const ByteView rlp{branch_buffer_.data(), static_cast<size_t>(out - branch_buffer_.data())};
+        const ethash::hash256 hash{keccak256(rlp)};
+        if (proof_retainer && proof_retainer->on_target_path(path)) {
+            proof_retainer->retain(path, rlp);
+        }
+        pop_stack(stack_.size() - first_child_idx);
+        push_hash(hash.bytes);
+        if (rlp_collector) {
+            rlp_collector(path, rlp, stack_.back());
+        }
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    size_t HashBuilderT<Collector, kKeyNibbles>::branch_ref(uint16_t state_mask, uint16_t hash_mask,
+                                                            PackedNibbles path) {
+        SILKWORM_ASSERT(is_subset(hash_mask, state_mask));
+        size_t num_hashes{0};
+
+        // The children are the topmost stack items
+        const auto num_children{static_cast<size_t>(std::popcount(state_mask))};
+        const size_t first_child_idx{stack_.size() - num_children};
+
+        for (size_t i{first_child_idx}, digit{0}; hash_mask && digit < 16; ++digit) {
+            if (hash_mask & (1u << digit)) {
+                SILKWORM_ASSERT(stack_[i].is_hash());
+                child_hashes_[num_hashes++] = stack_[i].hash();
+            }
+            if (state_mask & (1u << digit)) {
+                ++i;
+            }
+        }
+
+        size_t children_length{0};
+        for (size_t i{first_child_idx}; i < stack_.size(); ++i) {
+            children_length += stack_[i].length();
+        }
+
+        // Embedded children are shorter than wrapped hashes
+        if (children_length == num_children * NodeRef::kMaxLength) {
+            push_hash_branch_node(state_mask, first_child_idx, path);
+            return num_hashes;
+        }
+
+        // An empty string per missing child plus the nil value added below
+        const size_t payload_length{children_length + (16 - num_children) + 1};
+
+        push_node(path, payload_length, num_children, [&](auto &&write) {
+            for (size_t i{first_child_idx}, digit{0}; digit < 16; ++digit) {
+                if (state_mask & (1u << digit)) {
+                    write(stack_[i++]);
+                } else {
+                    write(ByteView{kEmptyStringRlp});
+                }
+            }
+
+            // branch nodes with values are not supported
+            write(ByteView{kEmptyStringRlp});
+        });
+
+        return num_hashes;
+    }
+
+// Format of HashBuilderT checkpoints, all integers being big-endian:
+// version (1 byte), flags (1 byte, see below),
+// packed key (u32 length, bytes), value (u32 length, bytes: leaf value or node hash),
+// groups, tree masks & hash masks (each u32 count, u16 masks),
+// stack (u32 count, then per node reference its length in 1 byte followed by its bytes)
+    inline constexpr uint8_t kCheckpointVersion{1};
+    inline constexpr uint8_t kCheckpointOddKey{0x01};
+    inline constexpr uint8_t kCheckpointNodeHash{0x02};  // value is the hash of a node added by add_branch_node
+    inline constexpr uint8_t kCheckpointInDbTrie{0x04};
+
+    inline void append_checkpoint_u32(Bytes &out, size_t value) {
+        uint8_t bytes[4];
+        endian::store_big_u32(bytes, static_cast<uint32_t>(value));
+        out.append(bytes, sizeof(bytes));
+    }
+
+    inline bool read_checkpoint_bytes(ByteView &from, size_t length, ByteView &out) noexcept {
+        if (from.length() < length) {
+            return false;
+        }
+        out = from.substr(0, length);
+        from.remove_prefix(length);
+        return true;
+    }
+
+    inline bool read_checkpoint_u32(ByteView &from, size_t &out) noexcept {
+        ByteView bytes;
+        if (!read_checkpoint_bytes(from, 4, bytes)) {
+            return false;
+        }
+        out = endian::load_big_u32(bytes.data());
+        return true;
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    Bytes HashBuilderT<Collector, kKeyNibbles>::save_checkpoint() const {
+        Bytes out;
+        const evmc::bytes32 *node_hash{std::get_if<evmc::bytes32>(&value_)};
+        uint8_t flags{0};
+        flags |= key_.odd ? kCheckpointOddKey : 0;
+        flags |= node_hash ? kCheckpointNodeHash : 0;
+        flags |= is_in_db_trie_ ? kCheckpointInDbTrie : 0;
+        out.push_back(kCheckpointVersion);
+        out.push_back(flags);
+
+        append_checkpoint_u32(out, key_.data.length());
+        out.append(key_.data);
+        const ByteView value{node_hash ? ByteView{node_hash->bytes, kHashLength} : std::get<ByteView>(value_)};
+        append_checkpoint_u32(out, value.length());
+        out.append(value);
+
+        for (const MaskStack *masks : {&groups_, &tree_masks_, &hash_masks_}) {
+            append_checkpoint_u32(out, masks->size());
+            for (size_t i{0}; i < masks->size(); ++i) {
+                uint8_t bytes[2];
+                endian::store_big_u16(bytes, (*masks)[i]);
+                out.append(bytes, sizeof(bytes));
+            }
+        }
+
+        append_checkpoint_u32(out, stack_.size());
+        for (const NodeRef &ref : stack_) {
+            out.push_back(static_cast<uint8_t>(ref.length()));
+            out.append(ByteView{ref});
+        }
+        return out;
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    DecodingResult HashBuilderT<Collector, kKeyNibbles>::load_checkpoint(ByteView checkpoint) {
+        if (checkpoint.length() < 2) {
+            return tl::unexpected{DecodingError::kInputTooShort};
+        }
+        const uint8_t flags{checkpoint[1]};
+        if (checkpoint[0] != kCheckpointVersion ||
+            (flags & ~(kCheckpointOddKey | kCheckpointNodeHash | kCheckpointInDbTrie))) {
+            return tl::unexpected{DecodingError::kInvalidFieldset};
+        }
+        checkpoint.remove_prefix(2);
+
+        // Everything is read before the builder is changed
+        size_t length{0};
+        ByteView key;
+        ByteView value;
+        if (!read_checkpoint_u32(checkpoint, length) || !read_checkpoint_bytes(checkpoint, length, key) ||
+            !read_checkpoint_u32(checkpoint, length) || !read_checkpoint_bytes(checkpoint, length, value)) {
+            return tl::unexpected{DecodingError::kInputTooShort};
+        }
+        const bool odd{(flags & kCheckpointOddKey) != 0};
+        const bool is_node_hash{(flags & kCheckpointNodeHash) != 0};
+        if ((key.empty() && odd) || (is_node_hash && value.length() != kHashLength)) {
+            return tl::unexpected{DecodingError::kUnexpectedLength};
+        }
+        if constexpr (kFixedLength) {
+            if (PackedNibbles{key, odd}.length() > kKeyNibbles) {
+                return tl::unexpected{DecodingError::kUnexpectedLength};
+            }
+        }
+
+        std::array<ByteView, 3> masks;
+        for (ByteView &m : masks) {
+            if (!read_checkpoint_u32(checkpoint, length) || !read_checkpoint_bytes(checkpoint, 2 * length, m)) {
+                return tl::unexpected{DecodingError::kInputTooShort};
+            }
+            if (kFixedLength && length > kKeyNibbles + 1) {
+                return tl::unexpected{DecodingError::kUnexpectedLength};
+            }
+        }
+
+        size_t num_refs{0};
+        if (!read_checkpoint_u32(checkpoint, num_refs)) {
+            return tl::unexpected{DecodingError::kInputTooShort};
+        }
+        const ByteView refs{checkpoint};
+        for (size_t i{0}; i < num_refs; ++i) {
+            ByteView ref;
+            if (checkpoint.empty() || !read_checkpoint_bytes(checkpoint, 1 + checkpoint[0], ref)) {
+                return tl::unexpected{DecodingError::kInputTooShort};
+            }
+            const size_t ref_length{ref[0]};
+            if (ref_length == 0 || ref_length > NodeRef::kMaxLength || ref_length == kHashLength ||
+                (ref_length == NodeRef::kMaxLength && ref[1] != rlp::kEmptyStringCode + kHashLength)) {
+                return tl::unexpected{DecodingError::kUnexpectedLength};
+            }
+        }
+        if (!checkpoint.empty()) {
+            return tl::unexpected{DecodingError::kInputTooLong};
+        }
+
+        reset();
+        key_buffer_.assign(key);
+        key_ = PackedNibbles{key_buffer_, odd};
+        if (is_node_hash) {
+            evmc::bytes32 hash;
+            std::memcpy(hash.bytes, value.data(), kHashLength);
+            value_ = hash;
+        } else {
+            copy_value(value);
+        }
+        is_in_db_trie_ = (flags & kCheckpointInDbTrie) != 0;
+
+        for (size_t k{0}; MaskStack *stack : {&groups_, &tree_masks_, &hash_masks_}) {
+            const ByteView m{masks[k++]};
+            stack->resize(m.length() / 2);
+            for (size_t i{0}; i < stack->size(); ++i) {
+                (*stack)[i] = endian::load_big_u16(&m[2 * i]);
+            }
+        }
+
+        stack_.reserve(num_refs);
+        for (ByteView from{refs}; !from.empty();) {
+            const ByteView ref{from.substr(1, from[0])};
+            from.remove_prefix(1 + ref.length());
+            if (ref.length() == NodeRef::kMaxLength) {
+                push_hash(std::span<const uint8_t, kHashLength>{&ref[1], kHashLength});
+            } else {
+                push_node_ref(ref);
+            }
+        }
+        return {};
+    }
+
+    template<class Collector, size_t kKeyNibbles>
+    void HashBuilderT<Collector, kKeyNibbles>::reset() {
+        key_ = PackedNibbles{};
+        value_ = ByteView{};
+        key_buffer_.clear();
+        value_buffer_.clear();
+        is_in_db_trie_ = false;
+        groups_.clear();
+        tree_masks_.clear();
+        hash_masks_.clear();
+        stack_.clear();
+        rlp_buffer_.clear();
+        path_buffer_.clear();
+        sponge_.reset();
+        bytes_copied_ = 0;
+    }
+
+}  // namespace silkworm::trie
+
+#endif  // SILKWORM_TRIE_HASH_BUILDER_IMPL_HPP
@@ -0,0 +1,100 @@
+#ifndef SILKWORM_TRIE_IN_MEMORY_TRIE_HPP
+#define SILKWORM_TRIE_IN_MEMORY_TRIE_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+
+#ifdef __cplusplus
+
+#include <memory>
+#include <optional>
+
+#include "evmc/evmc.hpp"
+
+namespace silkworm::trie {
+
+// Mutable Merkle Patricia Trie held in memory, for small edits followed by a root hash each time.
+// Every node caches its reference (either its RLP, if shorter than 32 bytes, or its hash), which is dropped
+// along the path of each modification only: root_hash rehashes the dirty nodes rather than all the leaves.
+// The root hash is the same as HashBuilder's for the same entries.
+    class InMemoryTrie {
+    public:
+        //! \brief Constructs an empty trie.
+        InMemoryTrie();
+
+        // Not copyable, movable
+        InMemoryTrie(const InMemoryTrie &) = delete;
+
+        InMemoryTrie &operator=(const InMemoryTrie &) = delete;
+
+        InMemoryTrie(InMemoryTrie &&) noexcept;
+
+        InMemoryTrie &operator=(InMemoryTrie &&) noexcept;
+
+        ~InMemoryTrie();
+
+        //! \brief Returns the value of key, if any
+        //! \remarks The view is valid until the key is modified
+        [[nodiscard]] std::optional<ByteView> get(ByteView key) const;
+
+        //! \brief Inserts or updates the value of key
+        //! \remarks An empty value erases the key, as in Ethereum
+        void put(ByteView key, ByteView value);
+
+        //! \brief Erases key
+        //! \return Whether the key was there
+        bool erase(ByteView key);
+
+        //! \brief Returns the root hash, rehashing the nodes modified since the previous call
+        evmc::bytes32 root_hash();
+
+        //! \brief Number of keys
+        [[nodiscard]] size_t size() const { return size_; }
+
+        [[nodiscard]] bool empty() const { return size_ == 0; }
+
+        void clear() noexcept;
+
+    private:
+        struct TrieNode;
+
+        static bool insert(std::unique_ptr<TrieNode> &node, ByteView path, ByteView value);
+
+        static bool remove(std::unique_ptr<TrieNode> &node, ByteView path);
+
+        static void normalize_branch(std::unique_ptr<TrieNode> &node);
+
+        static void normalize_extension(TrieNode &node);
+
+        static ByteView node_ref(TrieNode &node, Bytes &path_buffer);
+
+        std::unique_ptr<TrieNode> root_;
+        size_t size_{0};
+        Bytes path_buffer_;
+    };
+
+}  // namespace silkworm::trie
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct silkworm_InMemoryTrie silkworm_InMemoryTrie;
+
+silkworm_InMemoryTrie *silkworm_InMemoryTrie_new();
+void silkworm_InMemoryTrie_free(silkworm_InMemoryTrie *trie);
+
+// Returns non-zero and sets out_value if key is found
+int silkworm_InMemoryTrie_get(const silkworm_InMemoryTrie *trie, silkworm_ByteView key, silkworm_ByteView *out_value);
+void silkworm_InMemoryTrie_put(silkworm_InMemoryTrie *trie, silkworm_ByteView key, silkworm_ByteView value);
+int silkworm_InMemoryTrie_erase(silkworm_InMemoryTrie *trie, silkworm_ByteView key);
+
+void silkworm_InMemoryTrie_root_hash(silkworm_InMemoryTrie *trie, uint8_t out_hash[32]);
+size_t silkworm_InMemoryTrie_size(const silkworm_InMemoryTrie *trie);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILKWORM_TRIE_IN_MEMORY_TRIE_HPP
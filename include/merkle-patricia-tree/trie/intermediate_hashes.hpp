@@ -0,0 +1,169 @@
+#ifndef SILKWORM_TRIE_INTERMEDIATE_HASHES_HPP
+#define SILKWORM_TRIE_INTERMEDIATE_HASHES_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+#include "hash_builder.hpp"
+#include "prefix_set.hpp"
+
+#ifdef __cplusplus
+
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace silkworm::trie {
+
+    struct KeyValue {
+        ByteView key;
+        ByteView value;
+    };
+
+// Cursor over a table sorted by key, e.g. a database table, over which the state and the trie nodes are read
+    class KeyValueCursor {
+    public:
+        virtual ~KeyValueCursor() = default;
+
+        //! \brief Moves to the first entry whose key is not less than the provided one
+        //! \return The entry, if any; its views are valid until the cursor is moved or the entry erased
+        virtual std::optional<KeyValue> lower_bound(ByteView key) = 0;
+
+        //! \brief Moves to the entry following the current one
+        virtual std::optional<KeyValue> next() = 0;
+
+        //! \brief Erases the current entry
+        //! \remarks The cursor must be repositioned by lower_bound afterwards
+        virtual void erase() = 0;
+    };
+
+// KeyValueCursor over an ordered map, e.g. standing in for a database table in tests
+    class MapCursor final : public KeyValueCursor {
+    public:
+        explicit MapCursor(std::map<Bytes, Bytes> &map) : map_{map}, it_{map.end()} {}
+
+        std::optional<KeyValue> lower_bound(ByteView key) override;
+
+        std::optional<KeyValue> next() override;
+
+        void erase() override;
+
+    private:
+        std::optional<KeyValue> current() const;
+
+        std::map<Bytes, Bytes> &map_;
+        std::map<Bytes, Bytes>::iterator it_;
+    };
+
+// Walks over the nodes of the trie table in pre-order, descending into a stored branch only when its subtrie has
+// changes. Consumed nodes are erased from the table: HashBuilder collects them anew unless they are skipped whole.
+// See Erigon's AccTrieCursor
+    class TrieCursor {
+    public:
+        //! \param [in] cursor : over the trie table, keyed by nibbled path, with nodes encoded for storage
+        //! \param [in] changed : nibbled keys of the leaves changed since the trie table was built
+        TrieCursor(KeyValueCursor &cursor, PrefixSet &changed);
+
+        // Not copyable nor movable
+        TrieCursor(const TrieCursor &) = delete;
+
+        TrieCursor &operator=(const TrieCursor &) = delete;
+
+        //! \brief Moves to the next node, skipping the descendants of the current one if can_skip_state()
+        void next();
+
+        //! \brief Nibbled key of the current node; std::nullopt at the end of the trie
+        [[nodiscard]] std::optional<Bytes> key() const;
+
+        //! \brief Stored hash of the current node, if any
+        [[nodiscard]] const evmc::bytes32 *hash() const;
+
+        //! \brief Whether the nodes below the current one are stored in the trie table
+        [[nodiscard]] bool children_are_in_trie() const;
+
+        //! \brief Whether the current node is unchanged and has a stored hash, so its leaves needn't be read
+        [[nodiscard]] bool can_skip_state() const { return can_skip_state_; }
+
+        //! \brief Packed key from which the leaves not covered by the trie table so far are to be read
+        //! \return std::nullopt when all the leaves are covered
+        [[nodiscard]] std::optional<Bytes> first_uncovered_prefix() const;
+
+    private:
+        struct SubNode {
+            Bytes key;
+            std::optional<Node> node;
+            int nibble{-1};  // -1 when the node itself is current rather than one of its children
+
+            [[nodiscard]] Bytes full_key() const;
+
+            [[nodiscard]] bool state_flag() const;
+
+            [[nodiscard]] bool tree_flag() const;
+
+            [[nodiscard]] bool hash_flag() const;
+
+            [[nodiscard]] const evmc::bytes32 *hash() const;
+        };
+
+        void consume_node(ByteView key, bool exact);
+
+        void move_to_next_sibling(bool allow_root_to_child_nibble_within_subnode);
+
+        void update_skip_state();
+
+        KeyValueCursor &cursor_;
+        PrefixSet &changed_;
+        std::vector<SubNode> stack_;
+        bool can_skip_state_{false};
+    };
+
+// Calculates the root hash after a batch of changes, reading the leaves only within changed subtries and adding
+// the unchanged ones to HashBuilder by their stored hash.
+// See Erigon's FlatDBTrieLoader
+    class TrieLoader {
+    public:
+        //! \param [in] state : the leaves, keyed by packed (e.g. hashed) keys
+        //! \param [in] trie : the nodes collected by the previous run (or by HashBuilder), keyed by nibbled path and
+        //! encoded for storage. Nodes of changed subtries are erased, to be passed to node_collector anew
+        TrieLoader(KeyValueCursor &state, KeyValueCursor &trie) : state_{state}, trie_{trie} {}
+
+        //! \brief Receives the nodes to be stored into the trie table
+        //! \remarks They are to be written once calculate_root returns, since the trie table is being walked over
+        NodeCollector node_collector{nullptr};
+
+        //! \brief Returns the root hash of the state
+        //! \param [in] changed : nibbled keys of the leaves updated, inserted or erased since the trie table was built
+        evmc::bytes32 calculate_root(PrefixSet &changed);
+
+    private:
+        KeyValueCursor &state_;
+        KeyValueCursor &trie_;
+    };
+
+//! \brief Increments a nibbled key as a number in base 16
+//! \return std::nullopt on overflow, i.e. when all the nibbles are 0xF
+    std::optional<Bytes> increment_key(ByteView nibbles);
+
+}  // namespace silkworm::trie
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cursor implemented by C callbacks, returning non-zero when an entry is found; see KeyValueCursor
+typedef struct {
+    void *context;
+    int (*lower_bound)(void *context, silkworm_ByteView key, silkworm_ByteView *out_key, silkworm_ByteView *out_value);
+    int (*next)(void *context, silkworm_ByteView *out_key, silkworm_ByteView *out_value);
+    void (*erase)(void *context);
+} silkworm_KeyValueCursor;
+
+void silkworm_TrieLoader_calculate_root(silkworm_KeyValueCursor *state, silkworm_KeyValueCursor *trie,
+                                        silkworm_PrefixSet *changed, silkworm_NodeCollector collector,
+                                        uint8_t out_hash[32]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILKWORM_TRIE_INTERMEDIATE_HASHES_HPP
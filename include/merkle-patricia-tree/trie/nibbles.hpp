@@ -6,6 +6,10 @@
 
 #ifdef __cplusplus
 
+#include <compare>
+
+#include "merkle-patricia-tree/common/util.hpp"
+
 namespace silkworm::trie {
 
 //! \brief Transforms a string of of Nibbles into a string of Bytes
@@ -18,6 +22,43 @@ namespace silkworm::trie {
 //! \see Erigon's DecompressNibbles
     Bytes unpack_nibbles(ByteView data);
 
+//! \brief View of a string of Nibbles packed two per byte, high nibble first, as produced by pack_nibbles
+//! \remarks If odd is set the string is one nibble shorter than twice its bytes
+//! and the low nibble of the last byte, being padding, is ignored
+    struct PackedNibbles {
+        PackedNibbles() = default;
+
+        explicit PackedNibbles(ByteView packed, bool odd_length = false) noexcept: data{packed}, odd{odd_length} {}
+
+        //! \brief Number of nibbles
+        [[nodiscard]] size_t length() const noexcept { return data.length() * 2 - (odd ? 1 : 0); }
+
+        [[nodiscard]] bool empty() const noexcept { return data.empty(); }
+
+        uint8_t operator[](size_t i) const noexcept {
+            return (i & 1) ? data[i / 2] & 0x0F : data[i / 2] >> 4;
+        }
+
+        //! \brief View of the first count nibbles
+        [[nodiscard]] PackedNibbles prefix(size_t count) const noexcept {
+            return PackedNibbles{data.substr(0, (count + 1) / 2), (count & 1) != 0};
+        }
+
+        ByteView data;
+        bool odd{false};
+    };
+
+//! \brief Lexicographic order of the nibble strings, e.g. 0a < 0a00 < 0b
+    std::strong_ordering operator<=>(PackedNibbles a, PackedNibbles b) noexcept;
+
+    bool operator==(PackedNibbles a, PackedNibbles b) noexcept;
+
+// The overload below would otherwise hide the one for bytes
+    using silkworm::prefix_length;
+
+//! \brief The number of leading nibbles a and b have in common
+    size_t prefix_length(PackedNibbles a, PackedNibbles b) noexcept;
+
 }  // namespace silkworm::trie
 
 #endif // __cplusplus
@@ -8,7 +8,11 @@
 
 #include "evmc/evmc.hpp"
 
+#include <array>
+#include <bit>
+#include <initializer_list>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace silkworm::trie {
@@ -19,13 +23,24 @@ namespace silkworm::trie {
 // 1) tree_mask ⊆ state_mask
 // 2) hash_mask ⊆ state_mask
 // 3) #hash_mask == #hashes
+//
+// Hashes are held inline, up to one per child, so that a node is trivially copyable:
+// no allocation per collected node, nor pointer to chase when caching them.
     class Node {
     public:
+        static constexpr size_t kMaxHashes{16};
+
         Node() = default;
 
-        explicit Node(uint16_t state_mask, uint16_t tree_mask, uint16_t hash_mask, std::vector<evmc::bytes32> hashes,
+        explicit Node(uint16_t state_mask, uint16_t tree_mask, uint16_t hash_mask,
+                      std::span<const evmc::bytes32> hashes,
                       const std::optional<evmc::bytes32> &root_hash = std::nullopt);
 
+        explicit Node(uint16_t state_mask, uint16_t tree_mask, uint16_t hash_mask,
+                      std::initializer_list<evmc::bytes32> hashes,
+                      const std::optional<evmc::bytes32> &root_hash = std::nullopt)
+                : Node{state_mask, tree_mask, hash_mask, std::span{hashes.begin(), hashes.size()}, root_hash} {}
+
         // copyable
         Node(const Node &other) = default;
 
@@ -37,17 +52,25 @@ namespace silkworm::trie {
 
         [[nodiscard]] uint16_t hash_mask() const { return hash_mask_; }
 
-        [[nodiscard]] const std::vector<evmc::bytes32> &hashes() const { return hashes_; }
+        [[nodiscard]] std::span<const evmc::bytes32> hashes() const {
+            return {hashes_.data(), static_cast<size_t>(std::popcount(hash_mask_))};
+        }
 
         [[nodiscard]] const std::optional<evmc::bytes32> &root_hash() const { return root_hash_; }
 
         void set_root_hash(const std::optional<evmc::bytes32> &root_hash);
 
-        friend bool operator==(const Node &, const Node &) = default;
+        // Unused hash slots don't take part
+        friend bool operator==(const Node &a, const Node &b);
 
         //! \see Erigon's MarshalTrieNodeTyped
         [[nodiscard]] Bytes encode_for_storage() const;
 
+        //! \brief Same as above into out, of storage_length() bytes at least
+        void encode_for_storage(uint8_t *out) const;
+
+        [[nodiscard]] size_t storage_length() const;
+
         //! \see Erigon's UnmarshalTrieNodeTyped
         [[nodiscard]] static DecodingResult decode_from_storage(ByteView raw, Node &node);
 
@@ -55,12 +78,93 @@ namespace silkworm::trie {
         uint16_t state_mask_{0};  // Each bit set indicates parenting of a hashed state
         uint16_t tree_mask_{0};   // Each bit set indicates parenting of a child
         uint16_t hash_mask_{0};   // Each bit set indicates ownership of a valid hash
-        std::vector<evmc::bytes32> hashes_{};
+        std::array<evmc::bytes32, kMaxHashes> hashes_{};  // the leading popcount(hash_mask_) are valid
         std::optional<evmc::bytes32> root_hash_{std::nullopt};
 
     private:
     };
 
+// Read-only view of a node encoded for storage, e.g. straight from a memory-mapped table, read in place:
+// no hash is copied until asked for, which trie walkers seldom do beyond a single child.
+    class NodeView {
+    public:
+        NodeView() = default;
+
+        //! \brief Checks the layout as Node::decode_from_storage does and views raw on success
+        //! \attention raw must outlive the view
+        [[nodiscard]] static DecodingResult from_storage(ByteView raw, NodeView &view) noexcept;
+
+        [[nodiscard]] uint16_t state_mask() const noexcept { return state_mask_; }
+
+        [[nodiscard]] uint16_t tree_mask() const noexcept { return tree_mask_; }
+
+        [[nodiscard]] uint16_t hash_mask() const noexcept { return hash_mask_; }
+
+        //! \return nullptr if the node has no root hash
+        [[nodiscard]] const evmc::bytes32 *root_hash() const noexcept { return root_hash_; }
+
+        [[nodiscard]] std::span<const evmc::bytes32> hashes() const noexcept { return hashes_; }
+
+        //! \brief The hash of the child at nibble, if in hash_mask
+        [[nodiscard]] const evmc::bytes32 *child_hash(unsigned nibble) const noexcept {
+            if (!(hash_mask_ & (1u << nibble))) {
+                return nullptr;
+            }
+            return &hashes_[static_cast<size_t>(std::popcount(hash_mask_ & ((1u << nibble) - 1)))];
+        }
+
+        //! \brief Copies the node out of the viewed bytes
+        [[nodiscard]] Node to_node() const;
+
+    private:
+        uint16_t state_mask_{0};
+        uint16_t tree_mask_{0};
+        uint16_t hash_mask_{0};
+        const evmc::bytes32 *root_hash_{nullptr};
+        std::span<const evmc::bytes32> hashes_;
+    };
+
+// Nodes encoded for storage back to back in a single buffer, indexed by their offsets, e.g. those collected
+// during a block: a flush writes one buffer rather than allocating one per node.
+    class EncodedNodes {
+    public:
+        //! \brief Appends the encoding of a node, the same as Node::encode_for_storage
+        void append(const Node &node);
+
+        //! \brief Same as above for many nodes, growing the buffer once
+        void append(std::span<const Node> nodes);
+
+        [[nodiscard]] size_t size() const noexcept { return offsets_.size() - 1; }
+
+        [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+        //! \brief The encoding of the i-th node
+        [[nodiscard]] ByteView operator[](size_t i) const noexcept {
+            return ByteView{buffer_}.substr(offsets_[i], offsets_[i + 1] - offsets_[i]);
+        }
+
+        //! \brief All the encodings, back to back
+        [[nodiscard]] ByteView buffer() const noexcept { return buffer_; }
+
+        //! \brief Where each encoding begins within buffer(), followed by the end of the last one
+        [[nodiscard]] std::span<const size_t> offsets() const noexcept { return offsets_; }
+
+        void clear();
+
+        //! \brief Decodes the nodes encoded in buffer as indexed by offsets, appending them to nodes
+        //! \param [in] offsets : where each node begins within buffer, followed by where the last one ends
+        //! \remarks The masks of all the nodes are checked at once before any node is decoded, so nodes is left
+        //! unchanged on error, which is that of one of the invalid nodes
+        [[nodiscard]] static DecodingResult decode(ByteView buffer, std::span<const size_t> offsets,
+                                                   std::vector<Node> &nodes);
+
+        [[nodiscard]] DecodingResult decode(std::vector<Node> &nodes) const { return decode(buffer_, offsets_, nodes); }
+
+    private:
+        Bytes buffer_;
+        std::vector<size_t> offsets_{0};
+    };
+
     inline bool is_subset(uint16_t sub, uint16_t sup) { return (sub & sup) == sub; }
 
 }  // namespace silkworm::trie
@@ -0,0 +1,83 @@
+#ifndef SILKWORM_TRIE_NODE_REF_HPP
+#define SILKWORM_TRIE_NODE_REF_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+
+#ifdef __cplusplus
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+
+#include "evmc/evmc.hpp"
+#include "merkle-patricia-tree/common/util.hpp"
+#include "merkle-patricia-tree/rlp/encode.hpp"
+
+namespace silkworm::trie {
+
+// Reference to a node from its parent: either its RLP, if shorter than 32 bytes, or its RLP-wrapped hash,
+// i.e. 0xa0 followed by the 32 bytes of the hash. Either way it fits in 33 bytes, which are held inline
+// so that references are stacked, copied and returned without allocation.
+    class NodeRef {
+    public:
+        static constexpr size_t kMaxLength{kHashLength + 1};
+
+        //! \brief An empty reference, i.e. to no node
+        NodeRef() = default;
+
+        //! \brief Reference to the node of the given RLP, which is hashed unless shorter than 32 bytes
+        static NodeRef from_rlp(ByteView rlp) noexcept {
+            if (rlp.length() >= kHashLength) {
+                return from_hash(keccak256(rlp).bytes);
+            }
+            NodeRef ref;
+            std::memcpy(ref.bytes_.data(), rlp.data(), rlp.length());
+            ref.length_ = static_cast<uint8_t>(rlp.length());
+            return ref;
+        }
+
+        static NodeRef from_hash(std::span<const uint8_t, kHashLength> hash) noexcept {
+            NodeRef ref;
+            ref.bytes_[0] = rlp::kEmptyStringCode + kHashLength;
+            std::memcpy(&ref.bytes_[1], hash.data(), kHashLength);
+            ref.length_ = kMaxLength;
+            return ref;
+        }
+
+        [[nodiscard]] bool empty() const noexcept { return length_ == 0; }
+
+        [[nodiscard]] size_t length() const noexcept { return length_; }
+
+        [[nodiscard]] const uint8_t *data() const noexcept { return bytes_.data(); }
+
+        //! \brief Whether it's a wrapped hash rather than an embedded RLP
+        [[nodiscard]] bool is_hash() const noexcept { return length_ == kMaxLength; }
+
+        //! \pre is_hash()
+        [[nodiscard]] evmc::bytes32 hash() const noexcept {
+            evmc::bytes32 hash;
+            std::memcpy(hash.bytes, &bytes_[1], kHashLength);
+            return hash;
+        }
+
+        //! \brief The hash of the node, hashing an embedded RLP, e.g. that of a root shorter than 32 bytes
+        [[nodiscard]] evmc::bytes32 node_hash() const noexcept {
+            return is_hash() ? hash() : std::bit_cast<evmc::bytes32>(keccak256(*this));
+        }
+
+        operator ByteView() const noexcept { return {bytes_.data(), length_}; }
+
+        friend bool operator==(const NodeRef &a, const NodeRef &b) noexcept { return ByteView{a} == ByteView{b}; }
+
+    private:
+        std::array<uint8_t, kMaxLength> bytes_;  // only the leading length_ are meaningful
+        uint8_t length_{0};
+    };
+
+}  // namespace silkworm::trie
+
+#endif // __cplusplus
+
+#endif // SILKWORM_TRIE_NODE_REF_HPP
@@ -0,0 +1,116 @@
+#ifndef SILKWORM_TRIE_PARALLEL_HASH_BUILDER_HPP
+#define SILKWORM_TRIE_PARALLEL_HASH_BUILDER_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+#include "hash_builder.hpp"
+
+#ifdef __cplusplus
+
+#include <deque>
+#include <future>
+#include <utility>
+#include <vector>
+
+#include "merkle-patricia-tree/common/thread_pool.hpp"
+
+namespace silkworm::trie {
+
+// Result of building the subtrie of all the leaves sharing the same leading nibble(s)
+    struct Subtrie {
+        //! \brief The key of the only leaf or the longest common prefix of all the leaves
+        Bytes key;
+        //! \brief Value of the only leaf; empty if the subtrie has more than one leaf
+        Bytes value;
+        //! \brief Reference to the branch node at key (either a wrapped hash or an embedded RLP)
+        NodeRef node_ref;
+        //! \brief Leaves retained to be replayed when the branch node is embedded (i.e. can't be added by hash)
+        std::vector<std::pair<Bytes, Bytes>> leaves;
+        //! \brief Nodes collected while building the subtrie, in the order of the sequential builder
+        std::vector<std::pair<Bytes, Node>> nodes;
+    };
+
+//! \brief Builds the subtrie of the provided sorted leaves, which must share the same leading nibble(s)
+    Subtrie build_subtrie(std::vector<std::pair<Bytes, Bytes>> leaves, bool collect_nodes);
+
+//! \brief Adds a subtrie to a HashBuilder as if all its leaves were added one by one
+//! \remarks Collected nodes of the subtrie are passed to the node_collector of the HashBuilder
+    void fold_subtrie(HashBuilder &hb, Subtrie &subtrie);
+
+// Calculates the same root hash as HashBuilder, splitting the sorted stream of leaves into buckets by its leading
+// nibble(s), and further into buckets of bounded size, whose subtries are built in parallel (see build_range).
+// The subtries are then folded into the root by means of HashBuilder::add_branch_node.
+//
+// Memory is bounded: leaves are buffered bucket by bucket, and once 2 buckets per thread are being built,
+// adding a leaf waits for the oldest one.
+    class ParallelHashBuilder {
+    public:
+        static constexpr size_t kDefaultBucketSize{1u << 16};
+
+        //! \param [in] num_threads : number of worker threads; 0 means one per hardware thread
+        //! \param [in] split_nibbles : number of leading nibbles to split the leaves by, either 1 or 2
+        //! \param [in] bucket_size : maximum number of leaves of a bucket
+        explicit ParallelHashBuilder(size_t num_threads = 0, size_t split_nibbles = 1,
+                                     size_t bucket_size = kDefaultBucketSize);
+
+        // Not copyable nor movable
+        ParallelHashBuilder(const ParallelHashBuilder &) = delete;
+
+        ParallelHashBuilder &operator=(const ParallelHashBuilder &) = delete;
+
+        ~ParallelHashBuilder();
+
+        //! \details Same requirements as HashBuilder::add_leaf.
+        void add_leaf(Bytes nibbled_key, ByteView value);
+
+        //! \brief Returns the root hash computed on behalf of added entries
+        evmc::bytes32 root_hash();
+
+        //! \brief Same as HashBuilder::node_collector, invoked on the calling thread in the same order.
+        //! \remarks Must be set before the first leaf is added.
+        NodeCollector node_collector{nullptr};
+
+        //! \brief Resets the builder as newly created
+        void reset();
+
+    private:
+        void dispatch_bucket();
+
+        // Folds the subtries of the buckets built so far, waiting for the oldest ones while more than max_pending
+        // buckets are being built
+        void fold_subtries(size_t max_pending);
+
+        size_t split_nibbles_;
+        size_t bucket_size_;
+        ThreadPool pool_;
+        size_t max_pending_;
+
+        std::vector<std::pair<Bytes, Bytes>> bucket_;            // leaves sharing the current leading nibble(s)
+        std::deque<std::future<std::vector<Subtrie>>> pending_;  // subtries of the buckets being built, in key order
+        HashBuilder hb_;                                         // folds the subtries into the root
+    };
+
+}  // namespace silkworm::trie
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct silkworm_ParallelHashBuilder silkworm_ParallelHashBuilder;
+
+silkworm_ParallelHashBuilder *silkworm_ParallelHashBuilder_new(size_t num_threads, size_t split_nibbles);
+void silkworm_ParallelHashBuilder_free(silkworm_ParallelHashBuilder *builder);
+
+void silkworm_ParallelHashBuilder_add_leaf(silkworm_ParallelHashBuilder *builder, silkworm_ByteView nibbled_key,
+                                           silkworm_ByteView value);
+
+void silkworm_ParallelHashBuilder_root_hash(silkworm_ParallelHashBuilder *builder, uint8_t out_hash[32]);
+
+void silkworm_ParallelHashBuilder_reset(silkworm_ParallelHashBuilder *builder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILKWORM_TRIE_PARALLEL_HASH_BUILDER_HPP
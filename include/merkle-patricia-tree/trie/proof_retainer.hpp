@@ -0,0 +1,53 @@
+#ifndef SILKWORM_TRIE_PROOF_RETAINER_HPP
+#define SILKWORM_TRIE_PROOF_RETAINER_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+#include "nibbles.hpp"
+#include "prefix_set.hpp"
+
+#ifdef __cplusplus
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace silkworm::trie {
+
+// Retains the RLP of the nodes on the paths to a set of target keys while HashBuilder computes the root hash,
+// so that the proofs of all the targets, as returned by eth_getProof (EIP-1186), come out of a single pass.
+// Embedded nodes are part of the RLP of their parent, hence aren't retained unless being the root.
+    class ProofRetainer {
+    public:
+        //! \param [in] targets : nibbled keys to be proven, either present (inclusion) or not (exclusion)
+        explicit ProofRetainer(PrefixSet targets) : targets_{std::move(targets)} {}
+
+        //! \brief Whether the node at path lies on the path to any of the targets
+        //! \remarks Not marked const for the same reason as PrefixSet::contains
+        bool on_target_path(PackedNibbles path);
+
+        //! \brief Retains the RLP of the node at path
+        void retain(PackedNibbles path, ByteView rlp);
+
+        //! \brief Returns the RLPs of the retained nodes on the path to key, from the root down
+        //! \remarks key must be one of the targets
+        [[nodiscard]] std::vector<Bytes> proof(ByteView nibbled_key) const;
+
+        //! \brief Retained nodes keyed by nibbled path
+        [[nodiscard]] const std::map<Bytes, Bytes> &nodes() const { return nodes_; }
+
+        //! \brief Discards the retained nodes, keeping the targets
+        void clear() noexcept { nodes_.clear(); }
+
+    private:
+        void unpack_path(PackedNibbles path);
+
+        PrefixSet targets_;
+        std::map<Bytes, Bytes> nodes_;
+        Bytes path_buffer_;  // unpacked path being looked up
+    };
+
+}  // namespace silkworm::trie
+#endif
+
+#endif // SILKWORM_TRIE_PROOF_RETAINER_HPP
@@ -0,0 +1,116 @@
+#ifndef SILKWORM_TRIE_PROOF_VERIFIER_HPP
+#define SILKWORM_TRIE_PROOF_VERIFIER_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+#include "merkle-patricia-tree/common/decoding_result.hpp"
+
+#ifdef __cplusplus
+
+#include <array>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "evmc/evmc.hpp"
+
+namespace silkworm::trie {
+
+// Node of a proof, decoded in place: all the views point into its RLP
+    struct ProofNode {
+        enum class Kind : uint8_t {
+            kBranch,
+            kExtension,
+            kLeaf,
+        };
+
+        Kind kind{Kind::kBranch};
+
+        //! \brief Compact encoding of the path of a short node, i.e. including the flags nibble
+        ByteView path;
+
+        //! \brief RLP of the items of a branch node: 16 child references and the value.
+        //! A short node has a single item, either the child reference or the value.
+        std::array<ByteView, 17> items;
+
+        //! \brief Decodes a leaf, extension or branch node, building on rlp::decode_header
+        static DecodingResult decode(ByteView rlp, ProofNode &node) noexcept;
+    };
+
+// Verifies Merkle proofs (as returned by eth_getProof) against a root hash. Nodes are pooled by hash, so that
+// the ones shared by many proofs are decoded and hashed once. A multiproof, i.e. the union of the nodes of several
+// proofs in any order, is verified the same way as the separate proofs.
+    class ProofVerifier {
+    public:
+        explicit ProofVerifier(const evmc::bytes32 &root) : root_{root} {}
+
+        //! \brief Adds a node of a proof or of a multiproof
+        //! \remarks The node is viewed rather than copied, hence must outlive the verifier.
+        //! Nodes already added aren't hashed nor decoded again.
+        void add_node(ByteView rlp);
+
+        void add_nodes(std::span<const ByteView> nodes);
+
+        void add_nodes(std::span<const Bytes> nodes);
+
+        //! \brief Whether the nodes added prove that key has value, or that key is absent if value is empty
+        //! \param [in] key : packed path, e.g. a hashed key
+        [[nodiscard]] bool verify(ByteView key, ByteView value) const;
+
+        //! \brief Number of distinct nodes added, i.e. hashed and decoded
+        [[nodiscard]] size_t num_nodes() const { return nodes_.size(); }
+
+    private:
+        struct HashHasher {
+            size_t operator()(const evmc::bytes32 &hash) const noexcept;
+        };
+
+        struct RlpHasher {
+            size_t operator()(ByteView rlp) const noexcept {
+                return std::hash<std::string_view>{}({reinterpret_cast<const char *>(rlp.data()), rlp.length()});
+            }
+        };
+
+        struct PooledNode {
+            ProofNode node;
+            bool valid{false};
+        };
+
+        evmc::bytes32 root_;
+        std::unordered_map<ByteView, evmc::bytes32, RlpHasher> hashes_;  // of the nodes added, by content
+        std::unordered_map<evmc::bytes32, PooledNode, HashHasher> nodes_;
+    };
+
+    struct ProofClaim {
+        ByteView key;                 // packed path
+        ByteView value;               // empty for absence
+        std::span<const Bytes> proof;  // from the root down
+    };
+
+//! \brief Verifies many claims against the same root, nodes shared among their proofs being decoded & hashed once
+//! \return Whether each claim holds
+    std::vector<bool> verify_proofs(const evmc::bytes32 &root, std::span<const ProofClaim> claims);
+
+}  // namespace silkworm::trie
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct silkworm_ProofVerifier silkworm_ProofVerifier;
+
+silkworm_ProofVerifier *silkworm_ProofVerifier_new(const uint8_t root[32]);
+void silkworm_ProofVerifier_free(silkworm_ProofVerifier *verifier);
+
+// The node must outlive the verifier
+void silkworm_ProofVerifier_add_node(silkworm_ProofVerifier *verifier, silkworm_ByteView rlp);
+int silkworm_ProofVerifier_verify(const silkworm_ProofVerifier *verifier, silkworm_ByteView key,
+                                  silkworm_ByteView value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILKWORM_TRIE_PROOF_VERIFIER_HPP
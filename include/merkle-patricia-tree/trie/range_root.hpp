@@ -0,0 +1,67 @@
+#ifndef SILKWORM_TRIE_RANGE_ROOT_HPP
+#define SILKWORM_TRIE_RANGE_ROOT_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+#include "hash_builder.hpp"
+
+#ifdef __cplusplus
+
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "merkle-patricia-tree/common/thread_pool.hpp"
+#include "parallel_hash_builder.hpp"
+
+namespace silkworm::trie {
+
+// Partial structure of the trie built from a contiguous range of its sorted leaves, cut anywhere.
+// Any leaf of the range but the first and the last one lies in a subtrie having all its leaves within the range:
+// that of the shortest prefix which neither the first nor the last key of the range starts with.
+// Those subtries are built once and for all, down to the reference to their branch node, whereas the first and
+// the last leaf are kept as is: the prefix groups they close depend on the leaves beyond the range.
+// There are at most 16 such subtries per nibble of the boundary keys, whatever the size of the range.
+    struct TrieRange {
+        //! \brief The first leaf, the subtries within the range and the last leaf, in key order
+        std::vector<Subtrie> subtries;
+    };
+
+//! \brief Builds the partial structure of a range of leaves
+//! \param [in] leaves : consecutive leaves of the trie, sorted by key (unpacked); there may be any number of them
+//! \param [in] collect_nodes : whether the nodes of the subtries within the range are collected as well
+    TrieRange build_range(std::span<const std::pair<Bytes, Bytes>> leaves, bool collect_nodes);
+
+//! \brief Adds a range to a HashBuilder as if all its leaves were added one by one
+//! \remarks Folding adjacent ranges in key order, then calling root_hash, yields the same root (and nodes collected)
+//! as the sequential HashBuilder, without going through their leaves again
+    void fold_range(HashBuilder &hb, TrieRange &range);
+
+//! \brief Same root hash as HashBuilder, from sorted leaves cut into ranges of equal size built in parallel
+//! \param [in] pool : workers building the ranges; nullptr means the calling thread only
+//! \remarks Unlike ParallelHashBuilder, the work is spread evenly however skewed the keys are
+    evmc::bytes32 range_root_hash(std::span<const std::pair<Bytes, Bytes>> leaves, size_t num_ranges,
+                                  ThreadPool *pool = nullptr);
+
+}  // namespace silkworm::trie
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct silkworm_TrieRange silkworm_TrieRange;
+
+// Keys (unpacked) and values are parallel arrays of count consecutive sorted leaves
+silkworm_TrieRange *silkworm_TrieRange_build(const silkworm_ByteView *nibbled_keys, const silkworm_ByteView *values,
+                                             size_t count, int collect_nodes);
+void silkworm_TrieRange_free(silkworm_TrieRange *range);
+
+// Folds the range into the builder; ranges must be folded in key order
+void silkworm_TrieRange_fold(silkworm_TrieRange *range, silkworm_HashBuilder *builder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILKWORM_TRIE_RANGE_ROOT_HPP
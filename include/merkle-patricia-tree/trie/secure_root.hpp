@@ -0,0 +1,42 @@
+#ifndef SILKWORM_TRIE_SECURE_ROOT_HPP
+#define SILKWORM_TRIE_SECURE_ROOT_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+
+#ifdef __cplusplus
+
+#include <span>
+#include <utility>
+
+#include "evmc/evmc.hpp"
+#include "merkle-patricia-tree/common/thread_pool.hpp"
+
+namespace silkworm::trie {
+
+//! \brief Root hash of a "secure" trie, whose keys are the keccak hashes of the original ones,
+//! e.g. of the addresses of the state or of the slots of a storage
+//! \param [in] entries : unhashed keys along with their values (already RLP-encoded), in any order.
+//! Keys must be unique and values non-empty.
+//! \param [in] pool : workers hashing and sorting the keys; nullptr means the calling thread only
+//! \remarks Keys are hashed in batches of keccak256_batch, then sorted by hash, which is streamed into
+//! HashBuilder as packed keys, borrowing both hashes and values
+    evmc::bytes32 secure_root_hash(std::span<const std::pair<ByteView, ByteView>> entries,
+                                   ThreadPool *pool = nullptr);
+
+}  // namespace silkworm::trie
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Keys and values are parallel arrays of count items; hashed on the calling thread
+void silkworm_trie_secure_root_hash(uint8_t out_hash[32], const silkworm_ByteView *keys,
+                                    const silkworm_ByteView *values, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILKWORM_TRIE_SECURE_ROOT_HPP
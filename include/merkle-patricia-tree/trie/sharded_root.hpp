@@ -0,0 +1,76 @@
+#ifndef SILKWORM_TRIE_SHARDED_ROOT_HPP
+#define SILKWORM_TRIE_SHARDED_ROOT_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+#include "hash_builder.hpp"
+
+#ifdef __cplusplus
+
+#include <filesystem>
+#include <span>
+#include <utility>
+
+namespace silkworm::trie {
+
+//! \brief Writes sorted leaves as a file of leaves, i.e. records of the big-endian 32-bit lengths of the key and
+//! of the value followed by both, as in the runs of EtlHashBuilder
+//! \param [in] leaves : packed keys along with their values (already RLP-encoded), sorted by key
+//! \throws std::runtime_error if the file can't be written
+    void write_leaves_file(const std::filesystem::path &path, std::span<const std::pair<ByteView, ByteView>> leaves);
+
+// Calculates the same root hash as HashBuilder from a file of sorted leaves, building the subtries of its
+// leading nibble(s) in worker processes. A worker reads its own part of the file, hence its memory is
+// released when it exits and can't grow the heap of the coordinator, e.g. for a huge storage trie.
+// Each worker leaves the reference to the branch node of its subtrie, along with the nodes it collected, if any,
+// in a result file; the coordinator then folds the subtries into the root by means of HashBuilder::add_branch_node.
+//
+// Workers are forked on POSIX systems, so the coordinator had better be called while no other thread of the
+// process holds a lock. Elsewhere, the subtries are built one after the other by the calling process.
+    class ShardedRootCoordinator {
+    public:
+        //! \param [in] num_processes : workers running at once; 0 means one per hardware thread
+        //! \param [in] split_nibbles : number of leading nibbles to split the leaves by, either 1 or 2
+        //! \param [in] work_dir : directory of the result files; empty means the temporary directory of the system
+        explicit ShardedRootCoordinator(size_t num_processes = 0, size_t split_nibbles = 1,
+                                        std::filesystem::path work_dir = {});
+
+        //! \brief Receives the nodes of the trie as with HashBuilder, on the calling process and in the same order
+        //! \remarks Workers only collect nodes if it's set
+        NodeCollector node_collector{nullptr};
+
+        //! \brief Root hash of the leaves of the file
+        //! \param [in] leaves_file : as written by write_leaves_file; keys must be unique and at least split_nibbles
+        //! long, with the usual HashBuilder constraints
+        //! \throws std::runtime_error if the file can't be read, isn't sorted or a worker fails
+        evmc::bytes32 root_hash(const std::filesystem::path &leaves_file);
+
+    private:
+        size_t num_processes_;
+        size_t split_nibbles_;
+        std::filesystem::path work_dir_;
+    };
+
+}  // namespace silkworm::trie
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct silkworm_ShardedRootCoordinator silkworm_ShardedRootCoordinator;
+
+// A NULL or empty work_dir means the temporary directory of the system
+silkworm_ShardedRootCoordinator *silkworm_ShardedRootCoordinator_new(size_t num_processes, size_t split_nibbles,
+                                                                     const char *work_dir);
+void silkworm_ShardedRootCoordinator_free(silkworm_ShardedRootCoordinator *coordinator);
+
+// Returns non-zero on success, zero if the file can't be read or a worker fails
+int silkworm_ShardedRootCoordinator_root_hash(silkworm_ShardedRootCoordinator *coordinator, const char *leaves_file,
+                                              uint8_t out_hash[32]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILKWORM_TRIE_SHARDED_ROOT_HPP
@@ -0,0 +1,56 @@
+#ifndef SILKWORM_TRIE_UNSORTED_ROOT_HPP
+#define SILKWORM_TRIE_UNSORTED_ROOT_HPP
+
+#include "merkle-patricia-tree/common/base.hpp"
+#include "merkle-patricia-tree/common/bytes.hpp"
+
+#ifdef __cplusplus
+
+#include <array>
+#include <span>
+#include <utility>
+
+#include "evmc/evmc.hpp"
+#include "merkle-patricia-tree/common/thread_pool.hpp"
+
+namespace silkworm::trie {
+
+//! \brief Offsets of the buckets of the sorted entries by leading nibble:
+//! entries [b[i], b[i + 1]) start with nibble i, while empty keys, if any, precede b[0]
+    using RadixBuckets = std::array<size_t, 17>;
+
+//! \brief Sorts entries by key, two nibbles per byte, in place
+//! \param [in] pool : workers partitioning the entries and sorting the buckets; nullptr means the calling thread only
+//! \return The buckets of the leading nibble, i.e. the split points of the 16 subtries below the root
+//! \remarks Most-significant-digit radix sort over nibbles, partitioning the entries exactly as the trie does:
+//! 16-way counting passes down to small buckets, which are finished by a comparison sort.
+//! Equal keys are kept adjacent, in no particular order.
+    RadixBuckets radix_sort(std::span<std::pair<ByteView, ByteView>> entries, ThreadPool *pool = nullptr);
+
+//! \brief Same root hash as HashBuilder, from leaves in any order
+//! \param [in] entries : packed keys along with their values (already RLP-encoded).
+//! Keys must be unique, none a prefix of another, and values non-empty.
+//! \param [in] pool : workers sorting the leaves and building the subtries; nullptr means the calling thread only
+//! \throws std::invalid_argument if a key is empty, repeated or a prefix of another, whether built on a pool or not
+//! \remarks The entries are radix sorted, then on a pool the 16 subtries of the leading nibble are built
+//! in parallel and folded into the root; otherwise the sorted keys are streamed into HashBuilder as is
+    evmc::bytes32 unsorted_root_hash(std::span<const std::pair<ByteView, ByteView>> entries,
+                                     ThreadPool *pool = nullptr);
+
+}  // namespace silkworm::trie
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Keys (packed) and values are parallel arrays of count items; sorted and hashed on the calling thread.
+// Returns non-zero on success, zero if a key is empty, repeated or a prefix of another
+int silkworm_trie_unsorted_root_hash(uint8_t out_hash[32], const silkworm_ByteView *keys,
+                                     const silkworm_ByteView *values, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SILKWORM_TRIE_UNSORTED_ROOT_HPP
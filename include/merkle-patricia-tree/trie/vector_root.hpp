@@ -31,7 +31,7 @@ namespace silkworm::trie {
         Bytes index_rlp;
         Bytes value_rlp;
 
-        HashBuilder hb;
+        HashBuilderT<NoCollector> hb;
 
         for (size_t j{0}; j < v.size(); ++j) {
             const size_t index{adjust_index_for_rlp(j, v.size())};
@@ -40,7 +40,8 @@ namespace silkworm::trie {
             value_rlp.clear();
             std::forward<Encoder>(value_encoder)(value_rlp, v[index]);
 
-            hb.add_leaf(unpack_nibbles(index_rlp), value_rlp);
+            // The RLP of the index is the packed key itself
+            hb.add_leaf(PackedNibbles{index_rlp}, value_rlp);
         }
 
         return hb.root_hash();
@@ -0,0 +1,119 @@
+#include "merkle-patricia-tree/common/file.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+#include "merkle-patricia-tree/common/endian.hpp"
+
+namespace silkworm {
+
+    namespace {
+
+        [[noreturn]] void throw_io_error(const char *what, const std::filesystem::path &path) {
+            throw std::runtime_error{std::string{what} + " " + path.string()};
+        }
+
+    }  // namespace
+
+    FilePtr open_file(const std::filesystem::path &path, const char *mode) {
+#ifdef _WIN32
+        const std::string narrow_mode{mode};
+        const std::wstring wide_mode(narrow_mode.begin(), narrow_mode.end());
+        return FilePtr{_wfopen(path.c_str(), wide_mode.c_str())};
+#else
+        return FilePtr{std::fopen(path.c_str(), mode)};
+#endif
+    }
+
+    bool seek_file(std::FILE *file, int64_t offset, int origin) noexcept {
+#ifdef _WIN32
+        return _fseeki64(file, offset, origin) == 0;
+#else
+        return fseeko(file, static_cast<off_t>(offset), origin) == 0;
+#endif
+    }
+
+    RecordWriter::RecordWriter(const std::filesystem::path &path, size_t buffer_size)
+            : path_{path}, buffer_(buffer_size), file_{open_file(path, "wb")} {
+        if (!file_) {
+            throw_io_error("can't create", path_);
+        }
+        std::setvbuf(file_.get(), buffer_.data(), _IOFBF, buffer_.size());
+    }
+
+    void RecordWriter::write(ByteView bytes) {
+        if (std::fwrite(bytes.data(), 1, bytes.length(), file_.get()) != bytes.length()) {
+            throw_io_error("can't write", path_);
+        }
+    }
+
+    void RecordWriter::write_record(ByteView key, ByteView value) {
+        uint8_t header[kRecordHeaderLength];
+        endian::store_big_u32(&header[0], static_cast<uint32_t>(key.length()));
+        endian::store_big_u32(&header[4], static_cast<uint32_t>(value.length()));
+        write({header, sizeof(header)});
+        write(key);
+        write(value);
+    }
+
+    void RecordWriter::seek(uint64_t offset) {
+        if (!seek_file(file_.get(), static_cast<int64_t>(offset), SEEK_SET)) {
+            throw_io_error("can't write", path_);
+        }
+    }
+
+    void RecordWriter::close() {
+        if (std::fclose(file_.release()) != 0) {
+            throw_io_error("can't write", path_);
+        }
+    }
+
+    RecordReader::RecordReader(const std::filesystem::path &path, size_t buffer_size, uint64_t offset, uint64_t end)
+            : path_{path}, buffer_(buffer_size), file_{open_file(path, "rb")}, offset_{offset}, end_{end} {
+        if (!file_) {
+            throw_io_error("can't open", path_);
+        }
+        std::setvbuf(file_.get(), buffer_.data(), _IOFBF, buffer_.size());
+        if (offset && !seek_file(file_.get(), static_cast<int64_t>(offset), SEEK_SET)) {
+            throw_io_error("can't read", path_);
+        }
+    }
+
+    bool RecordReader::next(bool read_value) {
+        if (end_ && offset_ >= end_) {
+            return false;
+        }
+        uint8_t header[kRecordHeaderLength];
+        const size_t read{std::fread(header, 1, sizeof(header), file_.get())};
+        if (read == 0 && std::feof(file_.get())) {
+            return false;
+        }
+        // The lengths of a cut header are garbage, which mustn't size the key and the value
+        if (read != sizeof(header)) {
+            throw_io_error("can't read", path_);
+        }
+        record_offset_ = offset_;
+        key_.resize(endian::load_big_u32(&header[0]));
+        const uint32_t value_length{endian::load_big_u32(&header[4])};
+        value_.resize(read_value ? value_length : 0);
+        if (std::fread(key_.data(), 1, key_.length(), file_.get()) != key_.length() ||
+            (read_value ? std::fread(value_.data(), 1, value_length, file_.get()) != value_length
+                        : !seek_file(file_.get(), value_length, SEEK_CUR))) {
+            throw_io_error("can't read", path_);
+        }
+        offset_ += kRecordHeaderLength + key_.length() + value_length;
+        return true;
+    }
+
+    void RecordReader::read(uint8_t *out, size_t length) {
+        if (std::fread(out, 1, length, file_.get()) != length) {
+            throw_io_error("can't read", path_);
+        }
+        offset_ += length;
+    }
+
+}  // namespace silkworm
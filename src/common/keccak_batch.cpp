@@ -0,0 +1,301 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Multi-buffer Keccak-256: the states of 4 (AVX2) or 8 (AVX-512) independent inputs are interleaved,
+// so that a single Keccak-f[1600] permutation processes a block of each of them at once.
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "merkle-patricia-tree/common/assert.hpp"
+#include "merkle-patricia-tree/common/util.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SILKWORM_KECCAK_X86 1
+#include <immintrin.h>
+#endif
+
+namespace silkworm {
+
+    namespace {
+
+        constexpr size_t kRate{136};  // Keccak-256 rate in bytes
+        constexpr size_t kRateWords{kRate / 8};
+
+#if defined(SILKWORM_KECCAK_X86)
+
+        constexpr uint64_t kRoundConstants[24]{
+                0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
+                0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+                0x000000000000008a, 0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+                0x000000008000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003,
+                0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+                0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008,
+        };
+
+        // Rho offsets and Pi lane permutation, in the order lanes are visited starting from lane 1
+        constexpr int kRho[24]{1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44};
+        constexpr int kPi[24]{10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1};
+
+        __attribute__((target("avx2"))) inline __m256i rol_avx2(__m256i x, int n) {
+            return _mm256_or_si256(_mm256_sll_epi64(x, _mm_cvtsi32_si128(n)),
+                                   _mm256_srl_epi64(x, _mm_cvtsi32_si128(64 - n)));
+        }
+
+        // Keccak-f[1600] over 4 interleaved states: state[25][4]
+        __attribute__((target("avx2"))) void keccakf_avx2(uint64_t *state) {
+            __m256i st[25];
+            for (int i{0}; i < 25; ++i) {
+                st[i] = _mm256_load_si256(reinterpret_cast<const __m256i *>(state + 4 * i));
+            }
+
+            for (const uint64_t round_constant: kRoundConstants) {
+                // Theta
+                __m256i bc[5];
+                for (int i{0}; i < 5; ++i) {
+                    bc[i] = _mm256_xor_si256(_mm256_xor_si256(st[i], st[i + 5]),
+                                             _mm256_xor_si256(_mm256_xor_si256(st[i + 10], st[i + 15]), st[i + 20]));
+                }
+                for (int i{0}; i < 5; ++i) {
+                    const __m256i t{_mm256_xor_si256(bc[(i + 4) % 5], rol_avx2(bc[(i + 1) % 5], 1))};
+                    for (int j{0}; j < 25; j += 5) {
+                        st[j + i] = _mm256_xor_si256(st[j + i], t);
+                    }
+                }
+
+                // Rho & Pi
+                __m256i t{st[1]};
+                for (int i{0}; i < 24; ++i) {
+                    const __m256i next{st[kPi[i]]};
+                    st[kPi[i]] = rol_avx2(t, kRho[i]);
+                    t = next;
+                }
+
+                // Chi
+                for (int j{0}; j < 25; j += 5) {
+                    for (int i{0}; i < 5; ++i) {
+                        bc[i] = st[j + i];
+                    }
+                    for (int i{0}; i < 5; ++i) {
+                        st[j + i] = _mm256_xor_si256(bc[i], _mm256_andnot_si256(bc[(i + 1) % 5], bc[(i + 2) % 5]));
+                    }
+                }
+
+                // Iota
+                st[0] = _mm256_xor_si256(st[0], _mm256_set1_epi64x(static_cast<long long>(round_constant)));
+            }
+
+            for (int i{0}; i < 25; ++i) {
+                _mm256_store_si256(reinterpret_cast<__m256i *>(state + 4 * i), st[i]);
+            }
+        }
+
+        // The masked intrinsics of the avx512fintrin.h of GCC 12 pass _mm512_undefined_epi32() as the merge source,
+        // which -Wuninitialized flags once inlined (GCC bug 105593)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+        // Keccak-f[1600] over 8 interleaved states: state[25][8]
+        __attribute__((target("avx512f"))) void keccakf_avx512(uint64_t *state) {
+            __m512i st[25];
+            for (int i{0}; i < 25; ++i) {
+                st[i] = _mm512_load_si512(state + 8 * i);
+            }
+
+            for (const uint64_t round_constant: kRoundConstants) {
+                // Theta
+                __m512i bc[5];
+                for (int i{0}; i < 5; ++i) {
+                    // 0x96: a ^ b ^ c
+                    bc[i] = _mm512_ternarylogic_epi64(_mm512_ternarylogic_epi64(st[i], st[i + 5], st[i + 10], 0x96),
+                                                      st[i + 15], st[i + 20], 0x96);
+                }
+                for (int i{0}; i < 5; ++i) {
+                    const __m512i t{_mm512_xor_si512(bc[(i + 4) % 5], _mm512_rol_epi64(bc[(i + 1) % 5], 1))};
+                    for (int j{0}; j < 25; j += 5) {
+                        st[j + i] = _mm512_xor_si512(st[j + i], t);
+                    }
+                }
+
+                // Rho & Pi
+                __m512i t{st[1]};
+                for (int i{0}; i < 24; ++i) {
+                    const __m512i next{st[kPi[i]]};
+                    st[kPi[i]] = _mm512_rolv_epi64(t, _mm512_set1_epi64(kRho[i]));
+                    t = next;
+                }
+
+                // Chi, 0xD2: a ^ (~b & c)
+                for (int j{0}; j < 25; j += 5) {
+                    for (int i{0}; i < 5; ++i) {
+                        bc[i] = st[j + i];
+                    }
+                    for (int i{0}; i < 5; ++i) {
+                        st[j + i] = _mm512_ternarylogic_epi64(bc[i], bc[(i + 1) % 5], bc[(i + 2) % 5], 0xD2);
+                    }
+                }
+
+                // Iota
+                st[0] = _mm512_xor_si512(st[0], _mm512_set1_epi64(static_cast<long long>(round_constant)));
+            }
+
+            for (int i{0}; i < 25; ++i) {
+                _mm512_store_si512(state + 8 * i, st[i]);
+            }
+        }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+        // Hashes kLanes inputs spanning the same number of blocks
+        template<size_t kLanes>
+        void keccak256_lanes(const ByteView *inputs, ethash::hash256 *outputs, void (*keccakf)(uint64_t *)) {
+            alignas(64) uint64_t state[25 * kLanes]{};
+            uint8_t last_blocks[kLanes][kRate];
+
+            const size_t num_blocks{inputs[0].length() / kRate + 1};
+            for (size_t lane{0}; lane < kLanes; ++lane) {
+                SILKWORM_ASSERT(inputs[lane].length() / kRate + 1 == num_blocks);
+                // The final block holds the remainder of the input along with the padding
+                const ByteView remainder{inputs[lane].substr((num_blocks - 1) * kRate)};
+                std::memset(last_blocks[lane], 0, kRate);
+                if (!remainder.empty()) {
+                    std::memcpy(last_blocks[lane], remainder.data(), remainder.length());
+                }
+                last_blocks[lane][remainder.length()] ^= 0x01;
+                last_blocks[lane][kRate - 1] ^= 0x80;
+            }
+
+            for (size_t block{0}; block < num_blocks; ++block) {
+                for (size_t lane{0}; lane < kLanes; ++lane) {
+                    const uint8_t *data{block + 1 < num_blocks ? inputs[lane].data() + block * kRate
+                                                               : last_blocks[lane]};
+                    for (size_t word{0}; word < kRateWords; ++word) {
+                        uint64_t w;
+                        std::memcpy(&w, data + word * 8, 8);  // x86 is little endian
+                        state[word * kLanes + lane] ^= w;
+                    }
+                }
+                keccakf(state);
+            }
+
+            for (size_t lane{0}; lane < kLanes; ++lane) {
+                for (size_t word{0}; word < 4; ++word) {
+                    std::memcpy(&outputs[lane].bytes[word * 8], &state[word * kLanes + lane], 8);
+                }
+            }
+        }
+
+        template<size_t kLanes>
+        void keccak256_multi_buffer(std::span<const ByteView> inputs, std::span<ethash::hash256> outputs,
+                                    void (*keccakf)(uint64_t *)) {
+            // Inputs hashed together must span the same number of blocks
+            std::vector<size_t> order(inputs.size());
+            std::iota(order.begin(), order.end(), size_t{0});
+            std::stable_sort(order.begin(), order.end(), [&inputs](size_t a, size_t b) {
+                return inputs[a].length() / kRate < inputs[b].length() / kRate;
+            });
+
+            ByteView group[kLanes];
+            ethash::hash256 hashes[kLanes];
+            size_t i{0};
+            while (i < order.size()) {
+                const size_t num_blocks{inputs[order[i]].length() / kRate};
+                size_t end{i};
+                while (end < order.size() && inputs[order[end]].length() / kRate == num_blocks) {
+                    ++end;
+                }
+                for (; i + kLanes <= end; i += kLanes) {
+                    for (size_t lane{0}; lane < kLanes; ++lane) {
+                        group[lane] = inputs[order[i + lane]];
+                    }
+                    keccak256_lanes<kLanes>(group, hashes, keccakf);
+                    for (size_t lane{0}; lane < kLanes; ++lane) {
+                        outputs[order[i + lane]] = hashes[lane];
+                    }
+                }
+                for (; i < end; ++i) {
+                    outputs[order[i]] = keccak256(inputs[order[i]]);
+                }
+            }
+        }
+
+#endif  // SILKWORM_KECCAK_X86
+
+    }  // namespace
+
+    KeccakBackend keccak256_batch_backend() noexcept {
+#if defined(SILKWORM_KECCAK_X86)
+        static const KeccakBackend backend{[] {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return KeccakBackend::kAvx512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return KeccakBackend::kAvx2;
+            }
+            return KeccakBackend::kScalar;
+        }()};
+        return backend;
+#else
+        return KeccakBackend::kScalar;
+#endif
+    }
+
+    void keccak256_batch(std::span<const ByteView> inputs, std::span<ethash::hash256> outputs) {
+        keccak256_batch(inputs, outputs, keccak256_batch_backend());
+    }
+
+    void keccak256_batch(std::span<const ByteView> inputs, std::span<ethash::hash256> outputs,
+                         KeccakBackend backend) {
+        SILKWORM_ASSERT(outputs.size() >= inputs.size());
+        backend = std::min(backend, keccak256_batch_backend());
+
+#if defined(SILKWORM_KECCAK_X86)
+        switch (backend) {
+            case KeccakBackend::kAvx512:
+                keccak256_multi_buffer<8>(inputs, outputs, keccakf_avx512);
+                return;
+            case KeccakBackend::kAvx2:
+                keccak256_multi_buffer<4>(inputs, outputs, keccakf_avx2);
+                return;
+            case KeccakBackend::kScalar:
+                break;
+        }
+#endif
+
+        for (size_t i{0}; i < inputs.size(); ++i) {
+            outputs[i] = keccak256(inputs[i]);
+        }
+    }
+
+}  // namespace silkworm
+
+void silkworm_keccak256_batch(const silkworm_ByteView *inputs, size_t count, uint8_t (*outputs)[32]) {
+    std::vector<silkworm::ByteView> cpp_inputs;
+    cpp_inputs.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        cpp_inputs.emplace_back(inputs[i].data, inputs[i].length);
+    }
+    std::vector<ethash::hash256> cpp_outputs(count);
+    silkworm::keccak256_batch(cpp_inputs, cpp_outputs);
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(outputs[i], cpp_outputs[i].bytes, 32);
+    }
+}
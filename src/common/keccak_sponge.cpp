@@ -0,0 +1,93 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "merkle-patricia-tree/common/keccak_sponge.hpp"
+
+#include <cstring>
+
+#include <ethash/keccak.h>
+
+#include "merkle-patricia-tree/common/endian.hpp"
+
+namespace silkworm {
+
+    void KeccakSponge::absorb(ByteView data) noexcept {
+        // Byte by byte up to a word boundary, then word by word
+        while (!data.empty() && position_ % 8 != 0) {
+            absorb(data[0]);
+            data.remove_prefix(1);
+        }
+        while (data.length() >= 8) {
+            state_[position_ / 8] ^= endian::load_little_u64(data.data());
+            data.remove_prefix(8);
+            position_ += 8;
+            if (position_ == kRate) {
+                ethash_keccakf1600(state_);
+                position_ = 0;
+            }
+        }
+        for (const uint8_t byte: data) {
+            absorb(byte);
+        }
+    }
+
+    void KeccakSponge::absorb(uint8_t byte) noexcept {
+        state_[position_ / 8] ^= uint64_t{byte} << (8 * (position_ % 8));
+        if (++position_ == kRate) {
+            ethash_keccakf1600(state_);
+            position_ = 0;
+        }
+    }
+
+    ethash::hash256 KeccakSponge::finalize() noexcept {
+        // Keccak padding: 0x01 right after the data, 0x80 at the end of the block
+        state_[position_ / 8] ^= uint64_t{0x01} << (8 * (position_ % 8));
+        state_[kRate / 8 - 1] ^= uint64_t{0x80} << 56;
+        ethash_keccakf1600(state_);
+
+        ethash::hash256 hash;
+        for (size_t i{0}; i < 4; ++i) {
+            endian::store_little_u64(&hash.bytes[8 * i], state_[i]);
+        }
+        reset();
+        return hash;
+    }
+
+    void KeccakSponge::reset() noexcept {
+        std::memset(state_, 0, sizeof(state_));
+        position_ = 0;
+    }
+
+}  // namespace silkworm
+
+silkworm_KeccakSponge *silkworm_KeccakSponge_new() {
+    return reinterpret_cast<silkworm_KeccakSponge *>(new silkworm::KeccakSponge());
+}
+
+void silkworm_KeccakSponge_free(silkworm_KeccakSponge *sponge) {
+    delete reinterpret_cast<silkworm::KeccakSponge *>(sponge);
+}
+
+void silkworm_KeccakSponge_absorb(silkworm_KeccakSponge *sponge, silkworm_ByteView data) {
+    auto cpp_sponge = reinterpret_cast<silkworm::KeccakSponge *>(sponge);
+    cpp_sponge->absorb(silkworm::ByteView(data.data, data.length));
+}
+
+void silkworm_KeccakSponge_finalize(silkworm_KeccakSponge *sponge, uint8_t result[32]) {
+    auto cpp_sponge = reinterpret_cast<silkworm::KeccakSponge *>(sponge);
+    const ethash::hash256 hash = cpp_sponge->finalize();
+    std::memcpy(result, hash.bytes, 32);
+}
@@ -0,0 +1,52 @@
+#include "merkle-patricia-tree/common/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace silkworm {
+
+    ThreadPool::ThreadPool(size_t num_threads) {
+        if (num_threads == 0) {
+            num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        workers_.reserve(num_threads);
+        for (size_t i{0}; i < num_threads; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto &worker: workers_) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::post(std::function<void()> task) {
+        {
+            std::lock_guard lock{mutex_};
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    void ThreadPool::work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock{mutex_};
+                cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;  // stopping and drained
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+}  // namespace silkworm
@@ -0,0 +1,146 @@
+#include "merkle-patricia-tree/trie/async_node_sink.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace silkworm::trie {
+
+    void CollectedNodes::append(ByteView nibbled_key, const Node &node) {
+        keys_.append(nibbled_key);
+        key_offsets_.push_back(keys_.length());
+        nodes_.append(node);
+    }
+
+    void CollectedNodes::clear() {
+        keys_.clear();
+        key_offsets_.resize(1);
+        nodes_.clear();
+    }
+
+    AsyncNodeSink::AsyncNodeSink(BatchWriter writer, size_t batch_size, size_t num_batches)
+            : writer_{std::move(writer)}, batch_size_{std::max<size_t>(batch_size, 1)},
+              ring_(std::max<size_t>(num_batches, 2)) {
+        thread_ = std::thread{[this] { write_loop(); }};
+    }
+
+    AsyncNodeSink::~AsyncNodeSink() {
+        try {
+            if (!ring_[head_.load(std::memory_order_relaxed) % ring_.size()].empty()) {
+                publish();
+            }
+        } catch (...) {
+            // A writer failing while a batch awaited a free slot
+        }
+        stopping_.store(true, std::memory_order_release);
+        wakeups_.fetch_add(1, std::memory_order_release);
+        wakeups_.notify_one();
+        thread_.join();
+    }
+
+    void AsyncNodeSink::operator()(ByteView nibbled_key, const Node &node) {
+        rethrow_if_failed();
+        CollectedNodes &batch{ring_[head_.load(std::memory_order_relaxed) % ring_.size()]};
+        batch.append(nibbled_key, node);
+        if (batch.size() >= batch_size_) {
+            publish();
+        }
+    }
+
+    void AsyncNodeSink::flush() {
+        rethrow_if_failed();
+        const size_t head{head_.load(std::memory_order_relaxed)};
+        if (!ring_[head % ring_.size()].empty()) {
+            publish();
+        }
+        const size_t end{head_.load(std::memory_order_relaxed)};
+        for (size_t tail{tail_.load(std::memory_order_acquire)}; tail != end;
+             tail = tail_.load(std::memory_order_acquire)) {
+            tail_.wait(tail, std::memory_order_acquire);
+        }
+        rethrow_if_failed();
+    }
+
+    void AsyncNodeSink::publish() {
+        // Only this thread moves the head
+        const size_t head{head_.load(std::memory_order_relaxed) + 1};
+        head_.store(head, std::memory_order_release);
+        wakeups_.fetch_add(1, std::memory_order_release);
+        wakeups_.notify_one();
+
+        // Batches [tail_, head) are in flight; the new head is free once fewer than all of them are
+        size_t tail{tail_.load(std::memory_order_acquire)};
+        if (head - tail >= ring_.size()) {
+            ++stalls_;
+            do {
+                tail_.wait(tail, std::memory_order_acquire);
+                tail = tail_.load(std::memory_order_acquire);
+            } while (head - tail >= ring_.size());
+        }
+        ring_[head % ring_.size()].clear();
+    }
+
+    void AsyncNodeSink::rethrow_if_failed() {
+        if (failed_.load(std::memory_order_acquire)) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    void AsyncNodeSink::write_loop() {
+        for (size_t tail{0};;) {
+            const uint32_t wakeups{wakeups_.load(std::memory_order_acquire)};
+            if (tail == head_.load(std::memory_order_acquire)) {
+                if (stopping_.load(std::memory_order_acquire)) {
+                    return;
+                }
+                wakeups_.wait(wakeups, std::memory_order_acquire);
+                continue;
+            }
+
+            // Batches following a failure are dropped, yet released for the producer not to wait forever
+            if (!failed_.load(std::memory_order_relaxed)) {
+                try {
+                    writer_(ring_[tail % ring_.size()]);
+                } catch (...) {
+                    error_ = std::current_exception();
+                    failed_.store(true, std::memory_order_release);
+                }
+            }
+            tail_.store(++tail, std::memory_order_release);
+            tail_.notify_all();
+        }
+    }
+
+}  // namespace silkworm::trie
+
+silkworm_AsyncNodeSink *silkworm_AsyncNodeSink_new(silkworm_NodeBatchWriter writer, void *context,
+                                                   size_t batch_size, size_t num_batches) {
+    std::vector<silkworm_ByteView> keys;
+    std::vector<silkworm_ByteView> nodes;
+    auto cpp_writer = [=](const silkworm::trie::CollectedNodes &batch) mutable {
+        keys.clear();
+        nodes.clear();
+        for (size_t i{0}; i < batch.size(); ++i) {
+            const silkworm::ByteView key{batch.key(i)};
+            const silkworm::ByteView node{batch.node(i)};
+            keys.push_back(silkworm_ByteView{key.data(), key.length()});
+            nodes.push_back(silkworm_ByteView{node.data(), node.length()});
+        }
+        writer(context, keys.data(), nodes.data(), batch.size());
+    };
+    return reinterpret_cast<silkworm_AsyncNodeSink *>(
+            new silkworm::trie::AsyncNodeSink(std::move(cpp_writer), batch_size, num_batches));
+}
+
+void silkworm_AsyncNodeSink_free(silkworm_AsyncNodeSink *sink) {
+    delete reinterpret_cast<silkworm::trie::AsyncNodeSink *>(sink);
+}
+
+void silkworm_AsyncNodeSink_attach(silkworm_AsyncNodeSink *sink, silkworm_HashBuilder *builder) {
+    auto cpp_sink = reinterpret_cast<silkworm::trie::AsyncNodeSink *>(sink);
+    auto cpp_builder = reinterpret_cast<silkworm::trie::HashBuilder *>(builder);
+    cpp_builder->node_collector = cpp_sink->collector();
+}
+
+void silkworm_AsyncNodeSink_flush(silkworm_AsyncNodeSink *sink) {
+    reinterpret_cast<silkworm::trie::AsyncNodeSink *>(sink)->flush();
+}
@@ -0,0 +1,211 @@
+#include "merkle-patricia-tree/trie/etl_hash_builder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "merkle-patricia-tree/common/assert.hpp"
+#include "merkle-patricia-tree/common/file.hpp"
+#include "merkle-patricia-tree/trie/nibbles.hpp"
+#include "merkle-patricia-tree/trie/unsorted_root.hpp"
+
+namespace silkworm::trie {
+
+    namespace {
+
+        constexpr size_t kMinReadBufferSize{64u << 10};
+
+        // K-way merge of runs and of sorted leaves held in memory, passing every leaf to sink in key order
+        template<class Sink>
+        void merge_runs(std::span<const std::filesystem::path> runs,
+                        std::span<const std::pair<ByteView, ByteView>> buffered, size_t read_buffer_size, Sink &&sink) {
+            std::vector<RecordReader> readers;
+            readers.reserve(runs.size());
+            for (const auto &path : runs) {
+                readers.emplace_back(path, read_buffer_size);
+            }
+
+            // Index of the run holding the least key on top; readers.size() stands for the buffered leaves
+            size_t buffered_pos{0};
+            const size_t buffered_run{readers.size()};
+            const auto key_of{[&](size_t run) {
+                return run == buffered_run ? buffered[buffered_pos].first : readers[run].key();
+            }};
+            const auto greater{[&](size_t a, size_t b) { return key_of(a) > key_of(b); }};
+            std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap{greater};
+            for (size_t run{0}; run < readers.size(); ++run) {
+                if (readers[run].next()) {
+                    heap.push(run);
+                }
+            }
+            if (!buffered.empty()) {
+                heap.push(buffered_run);
+            }
+
+            while (!heap.empty()) {
+                const size_t run{heap.top()};
+                heap.pop();
+                if (run == buffered_run) {
+                    sink(buffered[buffered_pos].first, buffered[buffered_pos].second);
+                    if (++buffered_pos < buffered.size()) {
+                        heap.push(run);
+                    }
+                } else {
+                    sink(readers[run].key(), readers[run].value());
+                    if (readers[run].next()) {
+                        heap.push(run);
+                    }
+                }
+            }
+        }
+
+    }  // namespace
+
+    EtlHashBuilder::EtlHashBuilder(std::filesystem::path work_dir, size_t buffer_size, ThreadPool *pool,
+                                   size_t max_merge_width)
+            : work_dir_{work_dir.empty() ? std::filesystem::temp_directory_path() : std::move(work_dir)},
+              buffer_size_{buffer_size}, pool_{pool}, max_merge_width_{max_merge_width} {
+        SILKWORM_ASSERT(max_merge_width_ >= 2);
+        // Tells apart the runs of builders sharing the directory, even across processes
+        std::random_device random;
+        file_prefix_ = (uint64_t{random()} << 32) | random();
+    }
+
+    EtlHashBuilder::~EtlHashBuilder() { reset(); }
+
+    void EtlHashBuilder::add_leaf(ByteView key, ByteView value) {
+        entries_.push_back({buffer_.length(), static_cast<uint32_t>(key.length()),
+                            static_cast<uint32_t>(value.length())});
+        buffer_.append(key);
+        buffer_.append(value);
+        // Besides its bytes, a leaf takes its Entry, then while being sorted a view of it plus radix_sort's scratch
+        constexpr size_t kBytesPerEntry{sizeof(Entry) + 2 * sizeof(std::pair<ByteView, ByteView>)};
+        if (buffer_.length() + entries_.size() * kBytesPerEntry >= buffer_size_) {
+            spill();
+        }
+    }
+
+    std::vector<std::pair<ByteView, ByteView>> EtlHashBuilder::sorted_buffer() {
+        std::vector<std::pair<ByteView, ByteView>> leaves;
+        leaves.reserve(entries_.size());
+        const ByteView buffer{buffer_};
+        for (const Entry &entry : entries_) {
+            leaves.emplace_back(buffer.substr(entry.offset, entry.key_length),
+                                buffer.substr(entry.offset + entry.key_length, entry.value_length));
+        }
+        radix_sort(leaves, pool_);
+        return leaves;
+    }
+
+    std::filesystem::path EtlHashBuilder::next_run_path() {
+        return work_dir_ / ("mpt-etl-" + std::to_string(file_prefix_) + "-" + std::to_string(file_counter_++));
+    }
+
+    size_t EtlHashBuilder::read_buffer_size(size_t num_runs) const noexcept {
+        return std::max(buffer_size_ / num_runs, kMinReadBufferSize);
+    }
+
+    void EtlHashBuilder::spill() {
+        const auto leaves{sorted_buffer()};
+
+        const std::filesystem::path path{next_run_path()};
+        RecordWriter writer{path};
+        runs_.push_back(path);  // removed by reset even if incomplete
+        for (const auto &[key, value] : leaves) {
+            writer.write_record(key, value);
+        }
+        writer.close();
+
+        buffer_.clear();
+        entries_.clear();
+    }
+
+    evmc::bytes32 EtlHashBuilder::root_hash() {
+        HashBuilder hb;
+        hb.node_collector = node_collector;
+
+        // The leaves still buffered are merged from memory as an extra run
+        const auto buffered{sorted_buffer()};
+        if (runs_.empty()) {
+            for (const auto &[key, value] : buffered) {
+                hb.add_leaf_borrowed(PackedNibbles{key}, value);
+            }
+            const evmc::bytes32 root{hb.root_hash()};
+            reset();
+            return root;
+        }
+
+        // Opening every run at once could exceed the limit of open files, hence groups of the oldest (i.e. shortest)
+        // runs are first merged into longer ones, merging no more runs than needed to get down to max_merge_width_
+        while (runs_.size() > max_merge_width_) {
+            const size_t width{std::min(max_merge_width_, runs_.size() - max_merge_width_ + 1)};
+            const std::filesystem::path path{next_run_path()};
+            RecordWriter writer{path};
+            runs_.push_back(path);  // removed by reset even if incomplete
+            merge_runs(std::span{runs_}.first(width), {}, read_buffer_size(width),
+                       [&](ByteView key, ByteView value) { writer.write_record(key, value); });
+            writer.close();
+            for (size_t i{0}; i < width; ++i) {
+                std::error_code ec;
+                std::filesystem::remove(runs_[i], ec);
+            }
+            runs_.erase(runs_.begin(), runs_.begin() + static_cast<ptrdiff_t>(width));
+        }
+
+        merge_runs(runs_, buffered, read_buffer_size(runs_.size()),
+                   [&](ByteView key, ByteView value) { hb.add_leaf(PackedNibbles{key}, value); });
+
+        const evmc::bytes32 root{hb.root_hash()};
+        reset();
+        return root;
+    }
+
+    void EtlHashBuilder::reset() {
+        buffer_.clear();
+        entries_.clear();
+        for (const auto &path : runs_) {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+        runs_.clear();
+    }
+
+}  // namespace silkworm::trie
+
+silkworm_EtlHashBuilder *silkworm_EtlHashBuilder_new(const char *work_dir, size_t buffer_size) {
+    return reinterpret_cast<silkworm_EtlHashBuilder *>(new silkworm::trie::EtlHashBuilder(
+            work_dir ? std::filesystem::path{work_dir} : std::filesystem::path{},
+            buffer_size ? buffer_size : silkworm::trie::EtlHashBuilder::kDefaultBufferSize));
+}
+
+void silkworm_EtlHashBuilder_free(silkworm_EtlHashBuilder *builder) {
+    delete reinterpret_cast<silkworm::trie::EtlHashBuilder *>(builder);
+}
+
+int silkworm_EtlHashBuilder_add_leaf(silkworm_EtlHashBuilder *builder, silkworm_ByteView key,
+                                     silkworm_ByteView value) {
+    auto cpp_builder = reinterpret_cast<silkworm::trie::EtlHashBuilder *>(builder);
+    try {
+        cpp_builder->add_leaf(silkworm::ByteView{key.data, key.length}, silkworm::ByteView{value.data, value.length});
+    } catch (const std::exception &) {
+        return 0;
+    }
+    return 1;
+}
+
+int silkworm_EtlHashBuilder_root_hash(silkworm_EtlHashBuilder *builder, uint8_t out_hash[32]) {
+    auto cpp_builder = reinterpret_cast<silkworm::trie::EtlHashBuilder *>(builder);
+    try {
+        const evmc::bytes32 root{cpp_builder->root_hash()};
+        std::memcpy(out_hash, root.bytes, 32);
+    } catch (const std::exception &) {
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,331 @@
+#include "merkle-patricia-tree/trie/in_memory_trie.hpp"
+
+#include <array>
+#include <cstring>
+
+#include "merkle-patricia-tree/common/assert.hpp"
+#include "merkle-patricia-tree/common/empty_hashes.hpp"
+#include "merkle-patricia-tree/common/util.hpp"
+#include "merkle-patricia-tree/rlp/encode.hpp"
+#include "merkle-patricia-tree/trie/hash_builder_impl.hpp"
+#include "merkle-patricia-tree/trie/nibbles.hpp"
+#include "merkle-patricia-tree/trie/node_ref.hpp"
+
+namespace silkworm::trie {
+
+    struct InMemoryTrie::TrieNode {
+        enum class Kind : uint8_t {
+            kLeaf,
+            kExtension,
+            kBranch,
+        };
+
+        Kind kind;
+        Bytes path;                                          // nibbles of a leaf or an extension
+        Bytes value;                                         // of a leaf, or of a branch where a key ends
+        std::unique_ptr<TrieNode> child;                     // of an extension
+        std::array<std::unique_ptr<TrieNode>, 16> children;  // of a branch
+        NodeRef ref;  // empty while dirty
+
+        explicit TrieNode(Kind node_kind) : kind{node_kind} {}
+
+        static std::unique_ptr<TrieNode> leaf(ByteView path, ByteView value) {
+            auto node{std::make_unique<TrieNode>(Kind::kLeaf)};
+            node->path = path;
+            node->value = value;
+            return node;
+        }
+
+        static std::unique_ptr<TrieNode> extension(ByteView path, std::unique_ptr<TrieNode> child) {
+            SILKWORM_ASSERT(!path.empty());
+            auto node{std::make_unique<TrieNode>(Kind::kExtension)};
+            node->path = path;
+            node->child = std::move(child);
+            return node;
+        }
+    };
+
+    InMemoryTrie::InMemoryTrie() = default;
+
+    InMemoryTrie::InMemoryTrie(InMemoryTrie &&) noexcept = default;
+
+    InMemoryTrie &InMemoryTrie::operator=(InMemoryTrie &&) noexcept = default;
+
+    InMemoryTrie::~InMemoryTrie() = default;
+
+    void InMemoryTrie::clear() noexcept {
+        root_.reset();
+        size_ = 0;
+    }
+
+    std::optional<ByteView> InMemoryTrie::get(ByteView key) const {
+        const Bytes nibbles{unpack_nibbles(key)};
+        ByteView path{nibbles};
+        for (const TrieNode *node{root_.get()}; node;) {
+            switch (node->kind) {
+                case TrieNode::Kind::kLeaf:
+                    if (path == node->path) {
+                        return node->value;
+                    }
+                    return std::nullopt;
+                case TrieNode::Kind::kExtension:
+                    if (!path.starts_with(node->path)) {
+                        return std::nullopt;
+                    }
+                    path.remove_prefix(node->path.length());
+                    node = node->child.get();
+                    break;
+                case TrieNode::Kind::kBranch:
+                    if (path.empty()) {
+                        return node->value.empty() ? std::nullopt : std::optional<ByteView>{node->value};
+                    }
+                    node = node->children[path[0]].get();
+                    path.remove_prefix(1);
+                    break;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void InMemoryTrie::put(ByteView key, ByteView value) {
+        if (value.empty()) {
+            erase(key);
+            return;
+        }
+        if (insert(root_, unpack_nibbles(key), value)) {
+            ++size_;
+        }
+    }
+
+    bool InMemoryTrie::erase(ByteView key) {
+        if (!remove(root_, unpack_nibbles(key))) {
+            return false;
+        }
+        --size_;
+        return true;
+    }
+
+    bool InMemoryTrie::insert(std::unique_ptr<TrieNode> &node, ByteView path, ByteView value) {
+        if (!node) {
+            node = TrieNode::leaf(path, value);
+            return true;
+        }
+        node->ref = {};
+
+        if (node->kind == TrieNode::Kind::kBranch) {
+            if (path.empty()) {
+                const bool inserted{node->value.empty()};
+                node->value = value;
+                return inserted;
+            }
+            return insert(node->children[path[0]], path.substr(1), value);
+        }
+
+        const size_t common{prefix_length(node->path, path)};
+        if (node->kind == TrieNode::Kind::kLeaf && common == node->path.length() && common == path.length()) {
+            node->value = value;
+            return false;
+        }
+        if (node->kind == TrieNode::Kind::kExtension && common == node->path.length()) {
+            return insert(node->child, path.substr(common), value);
+        }
+
+        // The paths diverge: a branch node takes place at the first differing nibble
+        std::unique_ptr<TrieNode> old{std::move(node)};
+        auto branch{std::make_unique<TrieNode>(TrieNode::Kind::kBranch)};
+        if (common == old->path.length()) {
+            // only a leaf may end here, its key being a prefix of the new one
+            branch->value = std::move(old->value);
+        } else {
+            const uint8_t nibble{old->path[common]};
+            if (old->kind == TrieNode::Kind::kExtension && common + 1 == old->path.length()) {
+                branch->children[nibble] = std::move(old->child);
+            } else {
+                old->path.erase(0, common + 1);
+                branch->children[nibble] = std::move(old);
+            }
+        }
+        if (common == path.length()) {
+            branch->value = value;
+        } else {
+            branch->children[path[common]] = TrieNode::leaf(path.substr(common + 1), value);
+        }
+
+        node = common ? TrieNode::extension(path.substr(0, common), std::move(branch)) : std::move(branch);
+        return true;
+    }
+
+    bool InMemoryTrie::remove(std::unique_ptr<TrieNode> &node, ByteView path) {
+        if (!node) {
+            return false;
+        }
+        switch (node->kind) {
+            case TrieNode::Kind::kLeaf:
+                if (path != node->path) {
+                    return false;
+                }
+                node.reset();
+                return true;
+            case TrieNode::Kind::kExtension:
+                if (!path.starts_with(node->path) || !remove(node->child, path.substr(node->path.length()))) {
+                    return false;
+                }
+                node->ref = {};
+                normalize_extension(*node);
+                return true;
+            case TrieNode::Kind::kBranch:
+                if (path.empty()) {
+                    if (node->value.empty()) {
+                        return false;
+                    }
+                    node->value.clear();
+                } else if (!remove(node->children[path[0]], path.substr(1))) {
+                    return false;
+                }
+                node->ref = {};
+                normalize_branch(node);
+                return true;
+        }
+        return false;
+    }
+
+    // A branch node is left with at least one entry, since it had two before the removal
+    void InMemoryTrie::normalize_branch(std::unique_ptr<TrieNode> &node) {
+        int only_child{-1};
+        for (int i{0}; i < 16; ++i) {
+            if (node->children[i]) {
+                if (only_child >= 0 || !node->value.empty()) {
+                    return;  // still a branch
+                }
+                only_child = i;
+            }
+        }
+
+        if (only_child < 0) {
+            node = TrieNode::leaf({}, node->value);
+            return;
+        }
+
+        const auto nibble{static_cast<uint8_t>(only_child)};
+        std::unique_ptr<TrieNode> child{std::move(node->children[nibble])};
+        if (child->kind == TrieNode::Kind::kBranch) {
+            node = TrieNode::extension(ByteView{&nibble, 1}, std::move(child));
+        } else {
+            // the nibble is prepended to the path of the leaf or extension
+            child->path.insert(child->path.begin(), nibble);
+            child->ref = {};
+            node = std::move(child);
+        }
+    }
+
+    // An extension node whose child is no longer a branch merges with it
+    void InMemoryTrie::normalize_extension(TrieNode &node) {
+        SILKWORM_ASSERT(node.child);
+        TrieNode &child{*node.child};
+        if (child.kind == TrieNode::Kind::kBranch) {
+            return;
+        }
+        node.path.append(child.path);
+        if (child.kind == TrieNode::Kind::kLeaf) {
+            node.kind = TrieNode::Kind::kLeaf;
+            node.value = std::move(child.value);
+            node.child.reset();
+        } else {
+            node.child = std::move(child.child);
+        }
+    }
+
+    ByteView InMemoryTrie::node_ref(TrieNode &node, Bytes &path_buffer) {
+        if (!node.ref.empty()) {
+            return node.ref;
+        }
+
+        Bytes rlp;
+        switch (node.kind) {
+            case TrieNode::Kind::kLeaf:
+            case TrieNode::Kind::kExtension: {
+                const bool is_leaf{node.kind == TrieNode::Kind::kLeaf};
+                // the child reuses path_buffer, so goes first
+                const ByteView child_ref{is_leaf ? ByteView{} : node_ref(*node.child, path_buffer)};
+                const Bytes packed{pack_nibbles(node.path)};
+                encode_path(path_buffer, PackedNibbles{packed, node.path.length() % 2 != 0}, 0, is_leaf);
+                const size_t payload_length{rlp::length(path_buffer) +
+                                            (is_leaf ? rlp::length(node.value) : child_ref.length())};
+                rlp::encode_header(rlp, {.list = true, .payload_length = payload_length});
+                rlp::encode(rlp, path_buffer);
+                if (is_leaf) {
+                    rlp::encode(rlp, node.value);
+                } else {
+                    rlp.append(child_ref);
+                }
+                break;
+            }
+            case TrieNode::Kind::kBranch: {
+                size_t payload_length{rlp::length(node.value)};
+                for (const auto &child : node.children) {
+                    payload_length += child ? node_ref(*child, path_buffer).length() : 1;
+                }
+                rlp::encode_header(rlp, {.list = true, .payload_length = payload_length});
+                for (const auto &child : node.children) {
+                    if (child) {
+                        rlp.append(child->ref);
+                    } else {
+                        rlp.push_back(rlp::kEmptyStringCode);
+                    }
+                }
+                rlp::encode(rlp, node.value);
+                break;
+            }
+        }
+
+        node.ref = NodeRef::from_rlp(rlp);
+        return node.ref;
+    }
+
+    evmc::bytes32 InMemoryTrie::root_hash() {
+        if (!root_) {
+            return kEmptyRoot;
+        }
+        node_ref(*root_, path_buffer_);
+        return root_->ref.node_hash();  // the root is hashed even if shorter than 32 bytes
+    }
+
+}  // namespace silkworm::trie
+
+silkworm_InMemoryTrie *silkworm_InMemoryTrie_new() {
+    return reinterpret_cast<silkworm_InMemoryTrie *>(new silkworm::trie::InMemoryTrie());
+}
+
+void silkworm_InMemoryTrie_free(silkworm_InMemoryTrie *trie) {
+    delete reinterpret_cast<silkworm::trie::InMemoryTrie *>(trie);
+}
+
+int silkworm_InMemoryTrie_get(const silkworm_InMemoryTrie *trie, silkworm_ByteView key, silkworm_ByteView *out_value) {
+    auto cpp_trie = reinterpret_cast<const silkworm::trie::InMemoryTrie *>(trie);
+    const auto value{cpp_trie->get(silkworm::ByteView{key.data, key.length})};
+    if (!value) {
+        return 0;
+    }
+    *out_value = silkworm_ByteView{value->data(), value->length()};
+    return 1;
+}
+
+void silkworm_InMemoryTrie_put(silkworm_InMemoryTrie *trie, silkworm_ByteView key, silkworm_ByteView value) {
+    auto cpp_trie = reinterpret_cast<silkworm::trie::InMemoryTrie *>(trie);
+    cpp_trie->put(silkworm::ByteView{key.data, key.length}, silkworm::ByteView{value.data, value.length});
+}
+
+int silkworm_InMemoryTrie_erase(silkworm_InMemoryTrie *trie, silkworm_ByteView key) {
+    auto cpp_trie = reinterpret_cast<silkworm::trie::InMemoryTrie *>(trie);
+    return cpp_trie->erase(silkworm::ByteView{key.data, key.length}) ? 1 : 0;
+}
+
+void silkworm_InMemoryTrie_root_hash(silkworm_InMemoryTrie *trie, uint8_t out_hash[32]) {
+    auto cpp_trie = reinterpret_cast<silkworm::trie::InMemoryTrie *>(trie);
+    const evmc::bytes32 root{cpp_trie->root_hash()};
+    std::memcpy(out_hash, root.bytes, 32);
+}
+
+size_t silkworm_InMemoryTrie_size(const silkworm_InMemoryTrie *trie) {
+    return reinterpret_cast<const silkworm::trie::InMemoryTrie *>(trie)->size();
+}
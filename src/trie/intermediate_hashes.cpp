@@ -0,0 +1,317 @@
+#include "merkle-patricia-tree/trie/intermediate_hashes.hpp"
+
+#include <bit>
+#include <cstring>
+
+#include "merkle-patricia-tree/common/assert.hpp"
+#include "merkle-patricia-tree/trie/nibbles.hpp"
+
+namespace silkworm::trie {
+
+    std::optional<KeyValue> MapCursor::current() const {
+        if (it_ == map_.end()) {
+            return std::nullopt;
+        }
+        return KeyValue{it_->first, it_->second};
+    }
+
+    std::optional<KeyValue> MapCursor::lower_bound(ByteView key) {
+        it_ = map_.lower_bound(Bytes{key});
+        return current();
+    }
+
+    std::optional<KeyValue> MapCursor::next() {
+        if (it_ != map_.end()) {
+            ++it_;
+        }
+        return current();
+    }
+
+    void MapCursor::erase() {
+        SILKWORM_ASSERT(it_ != map_.end());
+        it_ = map_.erase(it_);
+    }
+
+    std::optional<Bytes> increment_key(ByteView nibbles) {
+        Bytes out{nibbles};
+        for (size_t i{out.length()}; i > 0; --i) {
+            uint8_t &nibble{out[i - 1]};
+            SILKWORM_ASSERT(nibble < 0x10);
+            if (nibble < 0xF) {
+                ++nibble;
+                return out;
+            }
+            nibble = 0;  // carry over
+        }
+        return std::nullopt;
+    }
+
+    TrieCursor::TrieCursor(KeyValueCursor &cursor, PrefixSet &changed) : cursor_{cursor}, changed_{changed} {
+        consume_node(/*key=*/{}, /*exact=*/true);
+    }
+
+    void TrieCursor::consume_node(ByteView key, bool exact) {
+        auto entry{cursor_.lower_bound(key)};
+        if (entry && exact && entry->key != key) {
+            entry.reset();
+        }
+
+        if (!entry && !exact) {
+            // end of the trie
+            stack_.clear();
+            return;
+        }
+
+        Bytes node_key{exact ? key : entry->key};
+        std::optional<Node> node;
+        if (entry) {
+            node.emplace();
+            const DecodingResult res{Node::decode_from_storage(entry->value, *node)};
+            SILKWORM_ASSERT(res.has_value());
+            SILKWORM_ASSERT(node->state_mask() != 0);
+        }
+
+        int nibble{0};
+        if (!node || node->root_hash()) {
+            nibble = -1;
+        } else {
+            nibble = std::countr_zero(node->state_mask());
+        }
+
+        if (!node_key.empty() && !stack_.empty()) {
+            // The root might be missing from the table, thus have no state mask to step through
+            stack_[0].nibble = node_key[0];
+        }
+
+        stack_.push_back(SubNode{std::move(node_key), std::move(node), nibble});
+
+        update_skip_state();
+
+        // Nodes skipped whole are the only ones HashBuilder won't collect again
+        if (entry && (!can_skip_state_ || nibble != -1)) {
+            cursor_.erase();
+        }
+    }
+
+    void TrieCursor::next() {
+        if (stack_.empty()) {
+            return;  // end of the trie
+        }
+
+        if (!can_skip_state_ && children_are_in_trie()) {
+            // descend into the child node
+            if (stack_.back().nibble < 0) {
+                move_to_next_sibling(/*allow_root_to_child_nibble_within_subnode=*/true);
+            } else {
+                consume_node(*key(), /*exact=*/false);
+            }
+        } else {
+            move_to_next_sibling(/*allow_root_to_child_nibble_within_subnode=*/false);
+        }
+
+        update_skip_state();
+    }
+
+    void TrieCursor::move_to_next_sibling(bool allow_root_to_child_nibble_within_subnode) {
+        while (!stack_.empty()) {
+            SubNode &sn{stack_.back()};
+            if (sn.nibble >= 15 || (sn.nibble < 0 && !allow_root_to_child_nibble_within_subnode)) {
+                // this node is fully traversed, move on within the parent
+                stack_.pop_back();
+                allow_root_to_child_nibble_within_subnode = false;
+                continue;
+            }
+
+            ++sn.nibble;
+
+            if (!sn.node) {
+                // no state mask to step through, so search the table
+                consume_node(*key(), /*exact=*/false);
+                return;
+            }
+
+            for (; sn.nibble < 16; ++sn.nibble) {
+                if (sn.state_flag()) {
+                    return;
+                }
+            }
+
+            stack_.pop_back();
+            allow_root_to_child_nibble_within_subnode = false;
+        }
+    }
+
+    void TrieCursor::update_skip_state() {
+        const std::optional<Bytes> k{key()};
+        if (!k || changed_.contains(*k)) {
+            can_skip_state_ = false;
+        } else {
+            can_skip_state_ = stack_.back().hash_flag();
+        }
+    }
+
+    std::optional<Bytes> TrieCursor::key() const {
+        if (stack_.empty()) {
+            return std::nullopt;
+        }
+        return stack_.back().full_key();
+    }
+
+    const evmc::bytes32 *TrieCursor::hash() const {
+        if (stack_.empty()) {
+            return nullptr;
+        }
+        return stack_.back().hash();
+    }
+
+    bool TrieCursor::children_are_in_trie() const {
+        if (stack_.empty()) {
+            return false;
+        }
+        return stack_.back().tree_flag();
+    }
+
+    std::optional<Bytes> TrieCursor::first_uncovered_prefix() const {
+        std::optional<Bytes> k{key()};
+        if (can_skip_state_ && k) {
+            k = increment_key(*k);
+        }
+        if (!k) {
+            return std::nullopt;
+        }
+        return pack_nibbles(*k);
+    }
+
+    Bytes TrieCursor::SubNode::full_key() const {
+        Bytes out{key};
+        if (nibble >= 0) {
+            out.push_back(static_cast<uint8_t>(nibble));
+        }
+        return out;
+    }
+
+    bool TrieCursor::SubNode::state_flag() const {
+        if (nibble < 0 || !node) {
+            return true;
+        }
+        return node->state_mask() & (1u << nibble);
+    }
+
+    bool TrieCursor::SubNode::tree_flag() const {
+        if (nibble < 0 || !node) {
+            return true;
+        }
+        return node->tree_mask() & (1u << nibble);
+    }
+
+    bool TrieCursor::SubNode::hash_flag() const {
+        if (!node) {
+            return false;
+        }
+        if (nibble < 0) {
+            return node->root_hash().has_value();
+        }
+        return node->hash_mask() & (1u << nibble);
+    }
+
+    const evmc::bytes32 *TrieCursor::SubNode::hash() const {
+        if (!hash_flag()) {
+            return nullptr;
+        }
+        if (nibble < 0) {
+            return &*node->root_hash();
+        }
+        const unsigned preceding_mask{(1u << nibble) - 1};
+        const auto hash_idx{static_cast<size_t>(std::popcount(node->hash_mask() & preceding_mask))};
+        return &node->hashes()[hash_idx];
+    }
+
+    evmc::bytes32 TrieLoader::calculate_root(PrefixSet &changed) {
+        HashBuilder hb;
+        hb.node_collector = node_collector;
+
+        Bytes bound;
+        for (TrieCursor trie{trie_, changed}; trie.key().has_value();) {
+            if (trie.can_skip_state()) {
+                SILKWORM_ASSERT(trie.hash() != nullptr);
+                hb.add_branch_node(*trie.key(), *trie.hash(), trie.children_are_in_trie());
+            }
+
+            const std::optional<Bytes> uncovered{trie.first_uncovered_prefix()};
+            if (!uncovered) {
+                break;  // all the remaining leaves are covered by stored hashes
+            }
+
+            trie.next();
+
+            // Leaves up to the next node of the trie table aren't covered by any stored hash
+            const std::optional<Bytes> next_key{trie.key()};
+            if (next_key) {
+                bound = pack_nibbles(*next_key);
+            }
+            const PackedNibbles next_node{bound, next_key && next_key->length() % 2 != 0};
+            for (auto leaf{state_.lower_bound(*uncovered)}; leaf; leaf = state_.next()) {
+                const PackedNibbles leaf_key{leaf->key};
+                if (next_key && next_node < leaf_key) {
+                    break;
+                }
+                hb.add_leaf(leaf_key, leaf->value);
+            }
+        }
+
+        return hb.root_hash();
+    }
+
+}  // namespace silkworm::trie
+
+namespace {
+
+    // Adapts the C callbacks to KeyValueCursor
+    class CKeyValueCursor final : public silkworm::trie::KeyValueCursor {
+    public:
+        explicit CKeyValueCursor(silkworm_KeyValueCursor &cursor) : cursor_{cursor} {}
+
+        std::optional<silkworm::trie::KeyValue> lower_bound(silkworm::ByteView key) override {
+            silkworm_ByteView out_key{}, out_value{};
+            if (!cursor_.lower_bound(cursor_.context, silkworm_ByteView{key.data(), key.length()}, &out_key,
+                                     &out_value)) {
+                return std::nullopt;
+            }
+            return to_key_value(out_key, out_value);
+        }
+
+        std::optional<silkworm::trie::KeyValue> next() override {
+            silkworm_ByteView out_key{}, out_value{};
+            if (!cursor_.next(cursor_.context, &out_key, &out_value)) {
+                return std::nullopt;
+            }
+            return to_key_value(out_key, out_value);
+        }
+
+        void erase() override { cursor_.erase(cursor_.context); }
+
+    private:
+        static silkworm::trie::KeyValue to_key_value(silkworm_ByteView key, silkworm_ByteView value) {
+            return {silkworm::ByteView{key.data, key.length}, silkworm::ByteView{value.data, value.length}};
+        }
+
+        silkworm_KeyValueCursor &cursor_;
+    };
+
+}  // namespace
+
+void silkworm_TrieLoader_calculate_root(silkworm_KeyValueCursor *state, silkworm_KeyValueCursor *trie,
+                                        silkworm_PrefixSet *changed, silkworm_NodeCollector collector,
+                                        uint8_t out_hash[32]) {
+    CKeyValueCursor cpp_state{*state};
+    CKeyValueCursor cpp_trie{*trie};
+    silkworm::trie::TrieLoader loader{cpp_state, cpp_trie};
+    if (collector) {
+        loader.node_collector = [collector](silkworm::ByteView nibbled_key, const silkworm::trie::Node &node) {
+            silkworm_ByteView c_nibbled_key{nibbled_key.data(), nibbled_key.length()};
+            collector(c_nibbled_key, &node);
+        };
+    }
+    const evmc::bytes32 root{loader.calculate_root(*reinterpret_cast<silkworm::trie::PrefixSet *>(changed))};
+    std::memcpy(out_hash, root.bytes, 32);
+}
@@ -1,5 +1,8 @@
 #include "merkle-patricia-tree/trie/nibbles.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 namespace silkworm::trie {
 
 Bytes pack_nibbles(ByteView unpacked) {
@@ -33,6 +36,35 @@ Bytes unpack_nibbles(ByteView data) {
     return out;
 }
 
+std::strong_ordering operator<=>(PackedNibbles a, PackedNibbles b) noexcept {
+    const size_t common_len{std::min(a.length(), b.length())};
+    if (const int cmp{common_len > 1 ? std::memcmp(a.data.data(), b.data.data(), common_len / 2) : 0}; cmp != 0) {
+        return cmp < 0 ? std::strong_ordering::less : std::strong_ordering::greater;
+    }
+    if (common_len & 1) {
+        // Only the high nibble of the last common byte belongs to both strings
+        const size_t last{common_len - 1};
+        if (const auto cmp{a[last] <=> b[last]}; cmp != 0) {
+            return cmp;
+        }
+    }
+    return a.length() <=> b.length();
+}
+
+bool operator==(PackedNibbles a, PackedNibbles b) noexcept { return (a <=> b) == 0; }
+
+size_t prefix_length(PackedNibbles a, PackedNibbles b) noexcept {
+    const size_t max_len{std::min(a.length(), b.length())};
+    const size_t num_bytes{(max_len + 1) / 2};
+    const auto [a_it, b_it]{std::mismatch(a.data.begin(), a.data.begin() + static_cast<ptrdiff_t>(num_bytes),
+                                          b.data.begin())};
+    if (a_it == a.data.begin() + static_cast<ptrdiff_t>(num_bytes)) {
+        return max_len;
+    }
+    const size_t len{static_cast<size_t>(a_it - a.data.begin()) * 2 + ((*a_it >> 4) == (*b_it >> 4) ? 1 : 0)};
+    return std::min(len, max_len);
+}
+
 }  // namespace silkworm::trie
 
 // C interface implementation
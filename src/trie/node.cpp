@@ -1,49 +1,79 @@
 #include "merkle-patricia-tree/trie/node.hpp"
 
+#include <algorithm>
 #include <bit>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "merkle-patricia-tree/common/assert.hpp"
 #include "merkle-patricia-tree/common/endian.hpp"
 
 namespace silkworm::trie {
 
-Node::Node(uint16_t state_mask, uint16_t tree_mask, uint16_t hash_mask, std::vector<evmc::bytes32> hashes,
+static_assert(std::is_trivially_copyable_v<Node>);
+
+Node::Node(uint16_t state_mask, uint16_t tree_mask, uint16_t hash_mask, std::span<const evmc::bytes32> hashes,
            const std::optional<evmc::bytes32>& root_hash)
     : state_mask_{state_mask},
       tree_mask_{tree_mask},
       hash_mask_{hash_mask},
-      hashes_{std::move(hashes)},
       root_hash_{root_hash} {
     SILKWORM_ASSERT(is_subset(tree_mask, state_mask));
     SILKWORM_ASSERT(is_subset(hash_mask, state_mask));
-    SILKWORM_ASSERT(std::cmp_equal(std::popcount(hash_mask_), hashes_.size()));
+    SILKWORM_ASSERT(std::cmp_equal(std::popcount(hash_mask_), hashes.size()));
+    std::copy(hashes.begin(), hashes.end(), hashes_.begin());
+}
+
+bool operator==(const Node& a, const Node& b) {
+    return a.state_mask_ == b.state_mask_ && a.tree_mask_ == b.tree_mask_ && a.hash_mask_ == b.hash_mask_ &&
+           a.root_hash_ == b.root_hash_ && std::ranges::equal(a.hashes(), b.hashes());
 }
 
 void Node::set_root_hash(const std::optional<evmc::bytes32>& root_hash) { root_hash_ = root_hash; }
 
-Bytes Node::encode_for_storage() const {
-    const size_t buf_size{/* 3 masks state/tree/hash 2 bytes each */ 6 +
-                          /* root hash */ (root_hash_.has_value() ? kHashLength : 0u) +
-                          /* hashes */ hashes_.size() * kHashLength};
-    Bytes buf(buf_size, '\0');
-    endian::store_big_u16(&buf[0], state_mask_);
-    endian::store_big_u16(&buf[2], tree_mask_);
-    endian::store_big_u16(&buf[4], hash_mask_);
+size_t Node::storage_length() const {
+    return /* 3 masks state/tree/hash 2 bytes each */ 6 +
+           /* root hash */ (root_hash_.has_value() ? kHashLength : 0u) +
+           /* hashes */ hashes().size() * kHashLength;
+}
+
+void Node::encode_for_storage(uint8_t* out) const {
+    endian::store_big_u16(&out[0], state_mask_);
+    endian::store_big_u16(&out[2], tree_mask_);
+    endian::store_big_u16(&out[4], hash_mask_);
 
     size_t pos{6};
     if (root_hash_.has_value()) {
-        std::memcpy(&buf[pos], root_hash_->bytes, kHashLength);
+        std::memcpy(&out[pos], root_hash_->bytes, kHashLength);
         pos += kHashLength;
     }
 
-    if (!hashes_.empty()) {
-        std::memcpy(&buf[pos], hashes_.data(), hashes_.size() * kHashLength);
+    if (!hashes().empty()) {
+        std::memcpy(&out[pos], hashes_.data(), hashes().size() * kHashLength);
     }
+}
+
+Bytes Node::encode_for_storage() const {
+    Bytes buf(storage_length(), '\0');
+    encode_for_storage(buf.data());
     return buf;
 }
 
 DecodingResult Node::decode_from_storage(ByteView raw, Node& node) {
+    NodeView view;
+    const DecodingResult res{NodeView::from_storage(raw, view)};
+    if (!res) {
+        return res;
+    }
+    node = view.to_node();
+    return {};
+}
+
+// Hashes are viewed in place, as they have no alignment requirement
+static_assert(sizeof(evmc::bytes32) == kHashLength && alignof(evmc::bytes32) == 1);
+
+DecodingResult NodeView::from_storage(ByteView raw, NodeView& view) noexcept {
     // At least state/tree/hash masks need to be present
     if (raw.length() < 6) {
         return tl::unexpected{DecodingError::kInputTooShort};
@@ -53,38 +83,114 @@ DecodingResult Node::decode_from_storage(ByteView raw, Node& node) {
         return tl::unexpected{DecodingError::kInvalidHashesLength};
     }
 
-    node.root_hash_.reset();
-    node.hashes_.clear();
-    node.state_mask_ = endian::load_big_u16(&raw[0]);
-    node.tree_mask_ = endian::load_big_u16(&raw[2]);
-    node.hash_mask_ = endian::load_big_u16(&raw[4]);
+    const uint16_t state_mask{endian::load_big_u16(&raw[0])};
+    const uint16_t tree_mask{endian::load_big_u16(&raw[2])};
+    const uint16_t hash_mask{endian::load_big_u16(&raw[4])};
 
-    if (!is_subset(node.tree_mask_, node.state_mask_) || !is_subset(node.hash_mask_, node.state_mask_)) {
+    if (!is_subset(tree_mask, state_mask) || !is_subset(hash_mask, state_mask)) {
         return tl::unexpected{DecodingError::kInvalidMasksSubsets};
     }
 
     raw.remove_prefix(6);
 
-    size_t expected_num_hashes{static_cast<size_t>(std::popcount(node.hash_mask_))};
-    size_t effective_num_hashes{raw.length() / kHashLength};
+    const auto expected_num_hashes{static_cast<size_t>(std::popcount(hash_mask))};
+    const size_t effective_num_hashes{raw.length() / kHashLength};
 
-    if (effective_num_hashes < expected_num_hashes) {
+    // Either one hash per bit of the hash mask, or a root hash first on top of them
+    if (effective_num_hashes < expected_num_hashes || effective_num_hashes > expected_num_hashes + 1) {
         return tl::unexpected{DecodingError::kInvalidHashesLength};
     }
 
-    size_t delta{effective_num_hashes - expected_num_hashes};
-    if (delta > 1) {
-        return tl::unexpected{DecodingError::kInvalidHashesLength};
-    } else if (delta == 1) {
-        node.root_hash_.emplace();
-        std::memcpy(node.root_hash_->bytes, raw.data(), kHashLength);
-        raw.remove_prefix(kHashLength);
-        --effective_num_hashes;
+    const auto* hashes{reinterpret_cast<const evmc::bytes32*>(raw.data())};
+    view.state_mask_ = state_mask;
+    view.tree_mask_ = tree_mask;
+    view.hash_mask_ = hash_mask;
+    view.root_hash_ = effective_num_hashes > expected_num_hashes ? hashes++ : nullptr;
+    view.hashes_ = {hashes, expected_num_hashes};
+    return {};
+}
+
+Node NodeView::to_node() const {
+    return Node{state_mask_, tree_mask_, hash_mask_, hashes_,
+                root_hash_ ? std::optional{*root_hash_} : std::nullopt};
+}
+
+void EncodedNodes::append(const Node& node) {
+    const size_t pos{buffer_.length()};
+    buffer_.resize(pos + node.storage_length());
+    node.encode_for_storage(&buffer_[pos]);
+    offsets_.push_back(buffer_.length());
+}
+
+void EncodedNodes::append(std::span<const Node> nodes) {
+    size_t length{0};
+    for (const Node& node : nodes) {
+        length += node.storage_length();
+    }
+    size_t pos{buffer_.length()};
+    buffer_.resize(pos + length);
+    offsets_.reserve(offsets_.size() + nodes.size());
+    for (const Node& node : nodes) {
+        node.encode_for_storage(&buffer_[pos]);
+        pos += node.storage_length();
+        offsets_.push_back(pos);
+    }
+}
+
+void EncodedNodes::clear() {
+    buffer_.clear();
+    offsets_.resize(1);
+}
+
+DecodingResult EncodedNodes::decode(ByteView buffer, std::span<const size_t> offsets, std::vector<Node>& nodes) {
+    if (offsets.empty()) {
+        return tl::unexpected{DecodingError::kInputTooShort};
+    }
+    const size_t count{offsets.size() - 1};
+
+    // The masks are gathered column by column, so that their subsets are checked in a single vectorizable pass
+    std::vector<uint16_t> masks(3 * count);
+    uint16_t* state_masks{masks.data()};
+    uint16_t* tree_masks{state_masks + count};
+    uint16_t* hash_masks{tree_masks + count};
+    for (size_t i{0}; i < count; ++i) {
+        if (offsets[i + 1] < offsets[i] || offsets[i + 1] > buffer.length() || offsets[i + 1] - offsets[i] < 6) {
+            return tl::unexpected{DecodingError::kInputTooShort};
+        }
+        const size_t length{offsets[i + 1] - offsets[i]};
+        if ((length - 6) % kHashLength != 0) {
+            return tl::unexpected{DecodingError::kInvalidHashesLength};
+        }
+        const uint8_t* raw{&buffer[offsets[i]]};
+        state_masks[i] = endian::load_big_u16(&raw[0]);
+        tree_masks[i] = endian::load_big_u16(&raw[2]);
+        hash_masks[i] = endian::load_big_u16(&raw[4]);
+
+        // Either one hash per bit of the hash mask, or a root hash first on top of them
+        const size_t num_hashes{(length - 6) / kHashLength};
+        const auto expected_num_hashes{static_cast<size_t>(std::popcount(hash_masks[i]))};
+        if (num_hashes < expected_num_hashes || num_hashes > expected_num_hashes + 1) {
+            return tl::unexpected{DecodingError::kInvalidHashesLength};
+        }
+    }
+
+    uint16_t stray_bits{0};
+    for (size_t i{0}; i < count; ++i) {
+        stray_bits |= static_cast<uint16_t>((tree_masks[i] | hash_masks[i]) & ~state_masks[i]);
+    }
+    if (stray_bits) {
+        return tl::unexpected{DecodingError::kInvalidMasksSubsets};
     }
 
-    node.hashes_.resize(effective_num_hashes);
-    if (effective_num_hashes) {
-        std::memcpy(node.hashes_.data(), raw.data(), raw.length());
+    nodes.reserve(nodes.size() + count);
+    for (size_t i{0}; i < count; ++i) {
+        const auto* hashes{reinterpret_cast<const evmc::bytes32*>(&buffer[offsets[i] + 6])};
+        const auto num_hashes{static_cast<size_t>(std::popcount(hash_masks[i]))};
+        std::optional<evmc::bytes32> root_hash;
+        if ((offsets[i + 1] - offsets[i] - 6) / kHashLength > num_hashes) {
+            root_hash = *hashes++;
+        }
+        nodes.emplace_back(state_masks[i], tree_masks[i], hash_masks[i], std::span{hashes, num_hashes}, root_hash);
     }
     return {};
 }
@@ -120,7 +226,7 @@ silkworm_Node* silkworm_Node_create_with_params(uint16_t state_mask, uint16_t tr
     }
 
     auto node = new silkworm_Node();
-    node->cpp_node = silkworm::trie::Node(state_mask, tree_mask, hash_mask, std::move(cpp_hashes), cpp_root_hash);
+    node->cpp_node = silkworm::trie::Node(state_mask, tree_mask, hash_mask, cpp_hashes, cpp_root_hash);
     return node;
 }
 
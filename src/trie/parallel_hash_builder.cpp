@@ -0,0 +1,163 @@
+#include "merkle-patricia-tree/trie/parallel_hash_builder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "merkle-patricia-tree/common/assert.hpp"
+#include "merkle-patricia-tree/common/util.hpp"
+#include "merkle-patricia-tree/trie/range_root.hpp"
+
+namespace silkworm::trie {
+
+    Subtrie build_subtrie(std::vector<std::pair<Bytes, Bytes>> leaves, bool collect_nodes) {
+        SILKWORM_ASSERT(!leaves.empty());
+        Subtrie subtrie;
+        if (leaves.size() == 1) {
+            subtrie.key = std::move(leaves[0].first);
+            subtrie.value = std::move(leaves[0].second);
+            return subtrie;
+        }
+
+        // All the leaves share this prefix and differ right after it, hence there's a branch node at it
+        const size_t prefix_len{prefix_length(leaves.front().first, leaves.back().first)};
+        subtrie.key = leaves.front().first.substr(0, prefix_len);
+
+        // The trie of the key suffixes has that very branch node as its root
+        HashBuilder hb;
+        if (collect_nodes) {
+            hb.node_collector = [&subtrie](ByteView nibbled_key, const Node &node) {
+                Bytes key{subtrie.key};
+                key.append(nibbled_key);
+                auto &collected{subtrie.nodes.emplace_back(std::move(key), node).second};
+                if (nibbled_key.empty()) {
+                    // Not the root of the whole trie
+                    collected.set_root_hash(std::nullopt);
+                }
+            };
+        }
+        for (const auto &[key, value]: leaves) {
+            hb.add_leaf(key.substr(prefix_len), value);
+        }
+        subtrie.node_ref = hb.root_node_ref();
+
+        if (!subtrie.node_ref.is_hash()) {
+            // Embedded branch nodes can't be added by hash.
+            // Anyway they have very few leaves and no stored children.
+            subtrie.leaves = std::move(leaves);
+            subtrie.nodes.clear();
+        }
+        return subtrie;
+    }
+
+    void fold_subtrie(HashBuilder &hb, Subtrie &subtrie) {
+        if (subtrie.node_ref.empty()) {
+            hb.add_leaf(std::move(subtrie.key), subtrie.value);
+        } else if (subtrie.node_ref.is_hash()) {
+            // The branch node is kept in the DB trie iff it has been collected
+            const bool is_in_db_trie{!subtrie.nodes.empty() && subtrie.nodes.back().first == subtrie.key};
+            hb.add_branch_node(std::move(subtrie.key), subtrie.node_ref.hash(), is_in_db_trie);
+        } else {
+            for (auto &[key, value]: subtrie.leaves) {
+                hb.add_leaf(std::move(key), value);
+            }
+        }
+
+        // Nodes of the preceding subtries, if any, have been closed by the addition above
+        if (hb.node_collector) {
+            for (const auto &[key, node]: subtrie.nodes) {
+                hb.node_collector(key, node);
+            }
+        }
+    }
+
+    ParallelHashBuilder::ParallelHashBuilder(size_t num_threads, size_t split_nibbles, size_t bucket_size)
+            : split_nibbles_{split_nibbles}, bucket_size_{std::max<size_t>(bucket_size, 1)}, pool_{num_threads},
+              max_pending_{2 * pool_.size()} {
+        SILKWORM_ASSERT(split_nibbles == 1 || split_nibbles == 2);
+    }
+
+    ParallelHashBuilder::~ParallelHashBuilder() = default;
+
+    void ParallelHashBuilder::add_leaf(Bytes nibbled_key, ByteView value) {
+        if (!bucket_.empty()) {
+            const ByteView last_key{bucket_.back().first};
+            SILKWORM_ASSERT(nibbled_key > last_key);
+            if (bucket_.size() >= bucket_size_ ||
+                last_key.substr(0, split_nibbles_) != ByteView{nibbled_key}.substr(0, split_nibbles_)) {
+                dispatch_bucket();
+            }
+        }
+        bucket_.emplace_back(std::move(nibbled_key), value);
+    }
+
+    evmc::bytes32 ParallelHashBuilder::root_hash() {
+        if (!bucket_.empty()) {
+            dispatch_bucket();
+        }
+        fold_subtries(/*max_pending=*/0);
+        return hb_.root_hash();
+    }
+
+    void ParallelHashBuilder::reset() {
+        for (auto &subtrie: pending_) {
+            subtrie.wait();
+        }
+        pending_.clear();
+        bucket_.clear();
+        hb_.reset();
+    }
+
+    void ParallelHashBuilder::dispatch_bucket() {
+        pending_.push_back(pool_.submit([leaves = std::move(bucket_), collect = static_cast<bool>(node_collector)] {
+            // A bucket may be cut anywhere within the leaves sharing its leading nibble(s)
+            return build_range(leaves, collect).subtries;
+        }));
+        bucket_.clear();
+
+        // Release the memory of the subtries already built, and bound that of the buckets being built
+        fold_subtries(max_pending_);
+    }
+
+    void ParallelHashBuilder::fold_subtries(size_t max_pending) {
+        hb_.node_collector = node_collector;
+        while (!pending_.empty()) {
+            std::future<std::vector<Subtrie>> &front{pending_.front()};
+            if (pending_.size() <= max_pending && front.wait_for(std::chrono::seconds{0}) != std::future_status::ready) {
+                return;
+            }
+            for (Subtrie &subtrie : front.get()) {
+                fold_subtrie(hb_, subtrie);
+            }
+            pending_.pop_front();
+        }
+    }
+
+}  // namespace silkworm::trie
+
+silkworm_ParallelHashBuilder *silkworm_ParallelHashBuilder_new(size_t num_threads, size_t split_nibbles) {
+    return reinterpret_cast<silkworm_ParallelHashBuilder *>(
+            new silkworm::trie::ParallelHashBuilder(num_threads, split_nibbles));
+}
+
+void silkworm_ParallelHashBuilder_free(silkworm_ParallelHashBuilder *builder) {
+    delete reinterpret_cast<silkworm::trie::ParallelHashBuilder *>(builder);
+}
+
+void silkworm_ParallelHashBuilder_add_leaf(silkworm_ParallelHashBuilder *builder, silkworm_ByteView nibbled_key,
+                                           silkworm_ByteView value) {
+    auto cpp_builder = reinterpret_cast<silkworm::trie::ParallelHashBuilder *>(builder);
+    silkworm::Bytes cpp_key(nibbled_key.data, nibbled_key.length);
+    silkworm::ByteView cpp_value(value.data, value.length);
+    cpp_builder->add_leaf(std::move(cpp_key), cpp_value);
+}
+
+void silkworm_ParallelHashBuilder_root_hash(silkworm_ParallelHashBuilder *builder, uint8_t out_hash[32]) {
+    auto cpp_builder = reinterpret_cast<silkworm::trie::ParallelHashBuilder *>(builder);
+    evmc::bytes32 root = cpp_builder->root_hash();
+    std::memcpy(out_hash, root.bytes, 32);
+}
+
+void silkworm_ParallelHashBuilder_reset(silkworm_ParallelHashBuilder *builder) {
+    auto cpp_builder = reinterpret_cast<silkworm::trie::ParallelHashBuilder *>(builder);
+    cpp_builder->reset();
+}
@@ -0,0 +1,35 @@
+#include "merkle-patricia-tree/trie/proof_retainer.hpp"
+
+namespace silkworm::trie {
+
+    void ProofRetainer::unpack_path(PackedNibbles path) {
+        path_buffer_.resize(path.length());
+        for (size_t i{0}; i < path.length(); ++i) {
+            path_buffer_[i] = path[i];
+        }
+    }
+
+    bool ProofRetainer::on_target_path(PackedNibbles path) {
+        unpack_path(path);
+        return targets_.contains(path_buffer_);
+    }
+
+    void ProofRetainer::retain(PackedNibbles path, ByteView rlp) {
+        if (rlp.length() < kHashLength && !path.empty()) {
+            return;  // embedded into its parent
+        }
+        unpack_path(path);
+        nodes_.insert_or_assign(path_buffer_, Bytes{rlp});
+    }
+
+    std::vector<Bytes> ProofRetainer::proof(ByteView nibbled_key) const {
+        std::vector<Bytes> out;
+        for (size_t len{0}; len <= nibbled_key.length(); ++len) {
+            if (const auto it{nodes_.find(Bytes{nibbled_key.substr(0, len)})}; it != nodes_.end()) {
+                out.push_back(it->second);
+            }
+        }
+        return out;
+    }
+
+}  // namespace silkworm::trie
@@ -0,0 +1,211 @@
+#include "merkle-patricia-tree/trie/proof_verifier.hpp"
+
+#include <bit>
+#include <cstring>
+
+#include "merkle-patricia-tree/common/endian.hpp"
+#include "merkle-patricia-tree/common/util.hpp"
+#include "merkle-patricia-tree/rlp/decode.hpp"
+#include "merkle-patricia-tree/trie/nibbles.hpp"
+
+namespace silkworm::trie {
+
+    namespace {
+
+        // Payload of an RLP string, e.g. a value
+        tl::expected<ByteView, DecodingError> string_payload(ByteView item) noexcept {
+            const auto header{rlp::decode_header(item)};
+            if (!header) {
+                return tl::unexpected{header.error()};
+            }
+            if (header->list) {
+                return tl::unexpected{DecodingError::kUnexpectedList};
+            }
+            return item.substr(0, header->payload_length);
+        }
+
+        bool value_matches(ByteView item, ByteView value) noexcept {
+            const auto payload{string_payload(item)};
+            return payload && *payload == value;
+        }
+
+    }  // namespace
+
+    DecodingResult ProofNode::decode(ByteView rlp, ProofNode &node) noexcept {
+        const auto header{rlp::decode_header(rlp)};
+        if (!header) {
+            return tl::unexpected{header.error()};
+        }
+        if (!header->list) {
+            return tl::unexpected{DecodingError::kUnexpectedString};
+        }
+        if (header->payload_length != rlp.length()) {
+            return tl::unexpected{header->payload_length > rlp.length() ? DecodingError::kInputTooShort
+                                                                        : DecodingError::kInputTooLong};
+        }
+
+        size_t count{0};
+        while (!rlp.empty()) {
+            if (count == node.items.size()) {
+                return tl::unexpected{DecodingError::kUnexpectedListElements};
+            }
+            const ByteView item{rlp};
+            const auto item_header{rlp::decode_header(rlp)};
+            if (!item_header) {
+                return tl::unexpected{item_header.error()};
+            }
+            if (item_header->payload_length > rlp.length()) {
+                return tl::unexpected{DecodingError::kInputTooShort};
+            }
+            rlp.remove_prefix(item_header->payload_length);
+            node.items[count++] = item.substr(0, item.length() - rlp.length());
+        }
+
+        if (count == node.items.size()) {
+            node.kind = Kind::kBranch;
+            node.path = {};
+            return {};
+        }
+        if (count != 2) {
+            return tl::unexpected{DecodingError::kUnexpectedListElements};
+        }
+
+        // See "Specification: Compact encoding of hex sequence with optional terminator"
+        // at https://eth.wiki/fundamentals/patricia-tree
+        const auto path{string_payload(node.items[0])};
+        if (!path) {
+            return tl::unexpected{path.error()};
+        }
+        if (path->empty() || (*path)[0] >= 0x40) {
+            return tl::unexpected{DecodingError::kInvalidFieldset};
+        }
+        node.path = *path;
+        node.kind = ((*path)[0] & 0x20) ? Kind::kLeaf : Kind::kExtension;
+        node.items[0] = node.items[1];
+        return {};
+    }
+
+    size_t ProofVerifier::HashHasher::operator()(const evmc::bytes32 &hash) const noexcept {
+        // Keccak output is uniformly distributed already
+        return static_cast<size_t>(endian::load_little_u64(hash.bytes));
+    }
+
+    void ProofVerifier::add_node(ByteView rlp) {
+        const auto [it, inserted]{hashes_.try_emplace(rlp)};
+        if (!inserted) {
+            return;
+        }
+        it->second = std::bit_cast<evmc::bytes32>(keccak256(rlp));
+        PooledNode &pooled{nodes_[it->second]};
+        pooled.valid = ProofNode::decode(rlp, pooled.node).has_value();
+    }
+
+    void ProofVerifier::add_nodes(std::span<const ByteView> nodes) {
+        for (const ByteView rlp : nodes) {
+            add_node(rlp);
+        }
+    }
+
+    void ProofVerifier::add_nodes(std::span<const Bytes> nodes) {
+        for (const Bytes &rlp : nodes) {
+            add_node(rlp);
+        }
+    }
+
+    bool ProofVerifier::verify(ByteView key, ByteView value) const {
+        const PackedNibbles nibbles{key};
+        size_t pos{0};
+
+        evmc::bytes32 hash{root_};
+        ByteView embedded_rlp;
+        ProofNode embedded;
+        while (true) {
+            const ProofNode *node{&embedded};
+            if (embedded_rlp.empty()) {
+                const auto it{nodes_.find(hash)};
+                if (it == nodes_.end() || !it->second.valid) {
+                    return false;  // missing or malformed node
+                }
+                node = &it->second.node;
+            } else if (!ProofNode::decode(embedded_rlp, embedded)) {
+                return false;
+            }
+
+            ByteView child_ref;
+            if (node->kind == ProofNode::Kind::kBranch) {
+                if (pos == nibbles.length()) {
+                    return value_matches(node->items[16], value);
+                }
+                child_ref = node->items[nibbles[pos++]];
+            } else {
+                // The path nibbles follow the flags nibble, and a padding one if even
+                const PackedNibbles path{node->path};
+                const size_t path_begin{(node->path[0] & 0x10) ? 1u : 2u};
+                const size_t path_len{path.length() - path_begin};
+                if (pos + path_len > nibbles.length()) {
+                    return value.empty();
+                }
+                for (size_t i{0}; i < path_len; ++i) {
+                    if (path[path_begin + i] != nibbles[pos + i]) {
+                        return value.empty();  // diverging path
+                    }
+                }
+                pos += path_len;
+                if (node->kind == ProofNode::Kind::kLeaf) {
+                    return pos == nibbles.length() ? value_matches(node->items[0], value) : value.empty();
+                }
+                child_ref = node->items[0];
+            }
+
+            // A child reference is either empty, a hash or an embedded node
+            if (child_ref.length() == 1 && child_ref[0] == rlp::kEmptyStringCode) {
+                return value.empty();
+            }
+            if (child_ref.length() == kHashLength + 1 && child_ref[0] == rlp::kEmptyStringCode + kHashLength) {
+                std::memcpy(hash.bytes, &child_ref[1], kHashLength);
+                embedded_rlp = {};
+            } else if (child_ref[0] >= rlp::kEmptyListCode) {
+                embedded_rlp = child_ref;
+            } else {
+                return false;
+            }
+        }
+    }
+
+    std::vector<bool> verify_proofs(const evmc::bytes32 &root, std::span<const ProofClaim> claims) {
+        ProofVerifier verifier{root};
+        for (const ProofClaim &claim : claims) {
+            verifier.add_nodes(claim.proof);
+        }
+        std::vector<bool> results;
+        results.reserve(claims.size());
+        for (const ProofClaim &claim : claims) {
+            results.push_back(verifier.verify(claim.key, claim.value));
+        }
+        return results;
+    }
+
+}  // namespace silkworm::trie
+
+silkworm_ProofVerifier *silkworm_ProofVerifier_new(const uint8_t root[32]) {
+    evmc::bytes32 cpp_root;
+    std::memcpy(cpp_root.bytes, root, 32);
+    return reinterpret_cast<silkworm_ProofVerifier *>(new silkworm::trie::ProofVerifier(cpp_root));
+}
+
+void silkworm_ProofVerifier_free(silkworm_ProofVerifier *verifier) {
+    delete reinterpret_cast<silkworm::trie::ProofVerifier *>(verifier);
+}
+
+void silkworm_ProofVerifier_add_node(silkworm_ProofVerifier *verifier, silkworm_ByteView rlp) {
+    auto cpp_verifier = reinterpret_cast<silkworm::trie::ProofVerifier *>(verifier);
+    cpp_verifier->add_node(silkworm::ByteView{rlp.data, rlp.length});
+}
+
+int silkworm_ProofVerifier_verify(const silkworm_ProofVerifier *verifier, silkworm_ByteView key,
+                                  silkworm_ByteView value) {
+    auto cpp_verifier = reinterpret_cast<const silkworm::trie::ProofVerifier *>(verifier);
+    return cpp_verifier->verify(silkworm::ByteView{key.data, key.length}, silkworm::ByteView{value.data, value.length})
+               ? 1
+               : 0;
+}
@@ -0,0 +1,94 @@
+#include "merkle-patricia-tree/trie/range_root.hpp"
+
+#include <algorithm>
+
+#include "merkle-patricia-tree/common/util.hpp"
+
+namespace silkworm::trie {
+
+    namespace {
+
+        void add_boundary_leaf(TrieRange &range, const std::pair<Bytes, Bytes> &leaf) {
+            Subtrie &subtrie{range.subtries.emplace_back()};
+            subtrie.key = leaf.first;
+            subtrie.value = leaf.second;
+        }
+
+    }  // namespace
+
+    TrieRange build_range(std::span<const std::pair<Bytes, Bytes>> leaves, bool collect_nodes) {
+        TrieRange range;
+        if (leaves.empty()) {
+            return range;
+        }
+        add_boundary_leaf(range, leaves.front());
+        if (leaves.size() == 1) {
+            return range;
+        }
+
+        const ByteView first{leaves.front().first};
+        const ByteView last{leaves.back().first};
+        for (size_t begin{1}, end{leaves.size() - 1}; begin < end;) {
+            // The shortest prefix of the leaf neither boundary key starts with: all its leaves lie in between
+            const ByteView key{leaves[begin].first};
+            const ByteView group{key.substr(0, std::max(prefix_length(key, first), prefix_length(key, last)) + 1)};
+            size_t group_end{begin + 1};
+            while (group_end < end && ByteView{leaves[group_end].first}.starts_with(group)) {
+                ++group_end;
+            }
+            range.subtries.push_back(build_subtrie({leaves.begin() + begin, leaves.begin() + group_end}, collect_nodes));
+            begin = group_end;
+        }
+
+        add_boundary_leaf(range, leaves.back());
+        return range;
+    }
+
+    void fold_range(HashBuilder &hb, TrieRange &range) {
+        for (Subtrie &subtrie : range.subtries) {
+            fold_subtrie(hb, subtrie);
+        }
+    }
+
+    evmc::bytes32 range_root_hash(std::span<const std::pair<Bytes, Bytes>> leaves, size_t num_ranges,
+                                  ThreadPool *pool) {
+        const size_t chunk{std::max<size_t>((leaves.size() + num_ranges - 1) / std::max<size_t>(num_ranges, 1), 1)};
+        std::vector<TrieRange> ranges((leaves.size() + chunk - 1) / chunk);
+        for_each_chunk(leaves.size(), chunk, pool, [&](size_t begin, size_t end) {
+            // A single chunk spanning all the leaves without a pool
+            for (; begin < end; begin += chunk) {
+                ranges[begin / chunk] = build_range(leaves.subspan(begin, std::min(chunk, end - begin)),
+                                                    /*collect_nodes=*/false);
+            }
+        });
+
+        HashBuilder hb;
+        for (TrieRange &range : ranges) {
+            fold_range(hb, range);
+        }
+        return hb.root_hash();
+    }
+
+}  // namespace silkworm::trie
+
+silkworm_TrieRange *silkworm_TrieRange_build(const silkworm_ByteView *nibbled_keys, const silkworm_ByteView *values,
+                                             size_t count, int collect_nodes) {
+    std::vector<std::pair<silkworm::Bytes, silkworm::Bytes>> leaves;
+    leaves.reserve(count);
+    for (size_t i{0}; i < count; ++i) {
+        leaves.emplace_back(silkworm::Bytes{nibbled_keys[i].data, nibbled_keys[i].length},
+                            silkworm::Bytes{values[i].data, values[i].length});
+    }
+    return reinterpret_cast<silkworm_TrieRange *>(
+            new silkworm::trie::TrieRange(silkworm::trie::build_range(leaves, collect_nodes != 0)));
+}
+
+void silkworm_TrieRange_free(silkworm_TrieRange *range) {
+    delete reinterpret_cast<silkworm::trie::TrieRange *>(range);
+}
+
+void silkworm_TrieRange_fold(silkworm_TrieRange *range, silkworm_HashBuilder *builder) {
+    auto cpp_range = reinterpret_cast<silkworm::trie::TrieRange *>(range);
+    auto cpp_builder = reinterpret_cast<silkworm::trie::HashBuilder *>(builder);
+    silkworm::trie::fold_range(*cpp_builder, *cpp_range);
+}
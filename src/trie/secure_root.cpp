@@ -0,0 +1,90 @@
+#include "merkle-patricia-tree/trie/secure_root.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "merkle-patricia-tree/common/endian.hpp"
+#include "merkle-patricia-tree/common/util.hpp"
+#include "merkle-patricia-tree/trie/hash_builder.hpp"
+#include "merkle-patricia-tree/trie/nibbles.hpp"
+
+namespace silkworm::trie {
+
+    namespace {
+
+        // Keys hashed per task, filling the SIMD lanes of keccak256_batch many times over
+        constexpr size_t kHashChunk{4096};
+
+        // Hashed key by its leading 8 bytes, which nearly always decide the order, and the index of the entry
+        struct SortItem {
+            uint64_t prefix;
+            size_t index;
+        };
+
+    }  // namespace
+
+    evmc::bytes32 secure_root_hash(std::span<const std::pair<ByteView, ByteView>> entries, ThreadPool *pool) {
+        const size_t count{entries.size()};
+
+        std::vector<ByteView> keys(count);
+        std::vector<ethash::hash256> hashes(count);
+        for_each_chunk(count, kHashChunk, pool, [&](size_t begin, size_t end) {
+            for (size_t i{begin}; i < end; ++i) {
+                keys[i] = entries[i].first;
+            }
+            keccak256_batch(std::span{keys}.subspan(begin, end - begin),
+                            std::span{hashes}.subspan(begin, end - begin));
+        });
+
+        // Hashes being uniformly distributed, their leading byte splits them into even buckets sorted independently
+        std::array<size_t, 257> bucket_begin{};
+        for (const auto &hash : hashes) {
+            ++bucket_begin[hash.bytes[0] + 1u];
+        }
+        for (size_t b{1}; b < bucket_begin.size(); ++b) {
+            bucket_begin[b] += bucket_begin[b - 1];
+        }
+        std::vector<SortItem> items(count);
+        std::array<size_t, 256> bucket_end{};
+        std::copy_n(bucket_begin.begin(), 256, bucket_end.begin());
+        for (size_t i{0}; i < count; ++i) {
+            items[bucket_end[hashes[i].bytes[0]]++] = {endian::load_big_u64(hashes[i].bytes), i};
+        }
+
+        const auto less{[&hashes](const SortItem &a, const SortItem &b) {
+            if (a.prefix != b.prefix) {
+                return a.prefix < b.prefix;
+            }
+            return std::memcmp(hashes[a.index].bytes, hashes[b.index].bytes, kHashLength) < 0;
+        }};
+        for_each_chunk(256, 16, count > kHashChunk ? pool : nullptr, [&](size_t first_bucket, size_t last_bucket) {
+            for (size_t b{first_bucket}; b < last_bucket; ++b) {
+                std::sort(items.begin() + static_cast<ptrdiff_t>(bucket_begin[b]),
+                          items.begin() + static_cast<ptrdiff_t>(bucket_begin[b + 1]), less);
+            }
+        });
+
+        // Hashes and values outlive the builder, hence are borrowed
+        HashedKeyHashBuilder<NoCollector> hb;
+        for (const SortItem &item : items) {
+            hb.add_leaf_borrowed(PackedNibbles{ByteView{hashes[item.index].bytes, kHashLength}},
+                                 entries[item.index].second);
+        }
+        return hb.root_hash();
+    }
+
+}  // namespace silkworm::trie
+
+void silkworm_trie_secure_root_hash(uint8_t out_hash[32], const silkworm_ByteView *keys,
+                                    const silkworm_ByteView *values, size_t count) {
+    std::vector<std::pair<silkworm::ByteView, silkworm::ByteView>> entries;
+    entries.reserve(count);
+    for (size_t i{0}; i < count; ++i) {
+        entries.emplace_back(silkworm::ByteView{keys[i].data, keys[i].length},
+                             silkworm::ByteView{values[i].data, values[i].length});
+    }
+    const evmc::bytes32 root{silkworm::trie::secure_root_hash(entries)};
+    std::memcpy(out_hash, root.bytes, 32);
+}
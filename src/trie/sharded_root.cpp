@@ -0,0 +1,302 @@
+#include "merkle-patricia-tree/trie/sharded_root.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "merkle-patricia-tree/common/assert.hpp"
+#include "merkle-patricia-tree/common/file.hpp"
+#include "merkle-patricia-tree/trie/nibbles.hpp"
+
+namespace silkworm::trie {
+
+    namespace {
+
+        // A result file starts with the reference to the branch node of the subtrie (its length, then up to 33 bytes)
+        // and whether that node has been collected, followed by the collected nodes as records
+        constexpr size_t kResultHeaderLength{1 + NodeRef::kMaxLength + 1};
+
+        [[noreturn]] void throw_io_error(const char *what, const std::filesystem::path &path) {
+            throw std::runtime_error{std::string{"ShardedRootCoordinator: "} + what + " " + path.string()};
+        }
+
+        // Leaves sharing the same leading nibble(s), i.e. the records [begin, end) of the file of leaves
+        struct Shard {
+            uint64_t begin{0};
+            uint64_t end{0};
+            size_t num_leaves{0};
+            Bytes first_key;  // packed
+            Bytes last_key;   // packed
+
+            // Nibbles shared by all the leaves, followed by the branch node of the subtrie if there are several
+            [[nodiscard]] size_t prefix_length() const noexcept {
+                return trie::prefix_length(PackedNibbles{first_key}, PackedNibbles{last_key});
+            }
+        };
+
+        std::vector<Shard> scan_shards(const std::filesystem::path &leaves_file, size_t split_nibbles) {
+            std::vector<Shard> shards;
+            RecordReader reader{leaves_file};
+            while (reader.next(/*read_value=*/false)) {
+                const ByteView key{reader.key()};
+                if (key.empty()) {
+                    throw_io_error("key shorter than the split in", leaves_file);
+                }
+                const uint8_t split{split_nibbles == 1 ? static_cast<uint8_t>(key[0] >> 4) : key[0]};
+                if (!shards.empty() && key <= ByteView{shards.back().last_key}) {
+                    throw_io_error("unsorted keys in", leaves_file);
+                }
+                if (shards.empty() ||
+                    (split_nibbles == 1 ? shards.back().last_key[0] >> 4 : shards.back().last_key[0]) != split) {
+                    Shard &shard{shards.emplace_back()};
+                    shard.begin = reader.record_offset();
+                    shard.first_key = key;
+                }
+                Shard &shard{shards.back()};
+                shard.end = reader.offset();
+                ++shard.num_leaves;
+                shard.last_key = key;
+            }
+            return shards;
+        }
+
+        // The leaves of a shard with their keys unpacked, e.g. to be replayed
+        std::vector<std::pair<Bytes, Bytes>> read_leaves(const std::filesystem::path &leaves_file,
+                                                         const Shard &shard) {
+            std::vector<std::pair<Bytes, Bytes>> leaves;
+            RecordReader reader{leaves_file, kDefaultRecordBufferSize, shard.begin, shard.end};
+            while (reader.next()) {
+                leaves.emplace_back(unpack_nibbles(reader.key()), reader.value());
+            }
+            return leaves;
+        }
+
+        // Run by a worker: builds the subtrie of a shard of several leaves into a result file
+        void build_shard(const std::filesystem::path &leaves_file, const Shard &shard,
+                         const std::filesystem::path &result_file, bool collect_nodes) {
+            const size_t prefix_len{shard.prefix_length()};
+            const Bytes prefix{unpack_nibbles(shard.first_key).substr(0, prefix_len)};
+
+            RecordWriter writer{result_file};
+            writer.write(Bytes(kResultHeaderLength, 0));  // filled in once the subtrie is built
+
+            // The trie of the key suffixes has the branch node at prefix as its root
+            HashBuilder hb;
+            bool root_collected{false};
+            Bytes key;
+            if (collect_nodes) {
+                hb.node_collector = [&](ByteView nibbled_key, const Node &node) {
+                    key.assign(prefix);
+                    key.append(nibbled_key);
+                    root_collected = nibbled_key.empty();
+                    if (root_collected) {
+                        // Not the root of the whole trie
+                        Node subtrie_root{node};
+                        subtrie_root.set_root_hash(std::nullopt);
+                        writer.write_record(key, subtrie_root.encode_for_storage());
+                    } else {
+                        writer.write_record(key, node.encode_for_storage());
+                    }
+                };
+            }
+            RecordReader reader{leaves_file, kDefaultRecordBufferSize, shard.begin, shard.end};
+            while (reader.next()) {
+                hb.add_leaf(unpack_nibbles(reader.key()).substr(prefix_len), reader.value());
+            }
+            const NodeRef ref{hb.root_node_ref()};
+
+            uint8_t header[kResultHeaderLength]{};
+            header[0] = static_cast<uint8_t>(ref.length());
+            std::memcpy(&header[1], ref.data(), ref.length());
+            header[kResultHeaderLength - 1] = root_collected ? 1 : 0;
+            writer.seek(0);
+            writer.write({header, sizeof(header)});
+            writer.close();
+        }
+
+        // Builds the subtries in worker processes, num_processes of them at most at once
+        template<class Build>
+        void run_workers(const std::vector<size_t> &shards, size_t num_processes, Build &&build) {
+#ifndef _WIN32
+            std::deque<pid_t> running;
+            const auto wait_oldest{[&running] {
+                const pid_t pid{running.front()};
+                running.pop_front();
+                int status{0};
+                while (waitpid(pid, &status, 0) < 0) {
+                    if (errno != EINTR) {
+                        return false;
+                    }
+                }
+                return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            }};
+
+            bool failed{false};
+            for (size_t shard : shards) {
+                if (running.size() >= num_processes && !wait_oldest()) {
+                    failed = true;
+                    break;
+                }
+                const pid_t pid{fork()};
+                if (pid < 0) {
+                    failed = true;
+                    break;
+                }
+                if (pid == 0) {
+                    // Exits without unwinding nor running the exit handlers of the coordinator
+                    int code{0};
+                    try {
+                        build(shard);
+                    } catch (...) {
+                        code = 1;
+                    }
+                    _exit(code);
+                }
+                running.push_back(pid);
+            }
+            while (!running.empty()) {
+                if (!wait_oldest()) {
+                    failed = true;
+                }
+            }
+            if (failed) {
+                throw std::runtime_error{"ShardedRootCoordinator: a worker failed"};
+            }
+#else
+            (void)num_processes;
+            for (size_t shard : shards) {
+                // Fails the same way as a worker process would
+                try {
+                    build(shard);
+                } catch (...) {
+                    throw std::runtime_error{"ShardedRootCoordinator: a worker failed"};
+                }
+            }
+#endif
+        }
+
+        // Result files, removed along with it
+        struct ResultFiles {
+            ~ResultFiles() {
+                for (const auto &path : paths) {
+                    std::error_code ec;
+                    std::filesystem::remove(path, ec);
+                }
+            }
+
+            std::vector<std::filesystem::path> paths;
+        };
+
+    }  // namespace
+
+    void write_leaves_file(const std::filesystem::path &path, std::span<const std::pair<ByteView, ByteView>> leaves) {
+        RecordWriter writer{path};
+        for (const auto &[key, value] : leaves) {
+            writer.write_record(key, value);
+        }
+        writer.close();
+    }
+
+    ShardedRootCoordinator::ShardedRootCoordinator(size_t num_processes, size_t split_nibbles,
+                                                   std::filesystem::path work_dir)
+            : num_processes_{num_processes ? num_processes : std::max(std::thread::hardware_concurrency(), 1u)},
+              split_nibbles_{split_nibbles},
+              work_dir_{work_dir.empty() ? std::filesystem::temp_directory_path() : std::move(work_dir)} {
+        SILKWORM_ASSERT(split_nibbles == 1 || split_nibbles == 2);
+    }
+
+    evmc::bytes32 ShardedRootCoordinator::root_hash(const std::filesystem::path &leaves_file) {
+        const std::vector<Shard> shards{scan_shards(leaves_file, split_nibbles_)};
+        const bool collect_nodes{static_cast<bool>(node_collector)};
+
+        // Tells apart the result files of coordinators sharing the directory, even across processes
+        std::random_device random;
+        const std::string file_prefix{"mpt-shard-" + std::to_string((uint64_t{random()} << 32) | random()) + "-"};
+        ResultFiles results;
+        std::vector<size_t> built;  // shards of a single leaf are added as is
+        for (size_t i{0}; i < shards.size(); ++i) {
+            results.paths.push_back(work_dir_ / (file_prefix + std::to_string(i)));
+            if (shards[i].num_leaves > 1) {
+                built.push_back(i);
+            }
+        }
+        run_workers(built, num_processes_, [&](size_t i) {
+            build_shard(leaves_file, shards[i], results.paths[i], collect_nodes);
+        });
+
+        HashBuilder hb;
+        hb.node_collector = node_collector;
+        for (size_t i{0}; i < shards.size(); ++i) {
+            const Shard &shard{shards[i]};
+            if (shard.num_leaves == 1) {
+                auto leaves{read_leaves(leaves_file, shard)};
+                hb.add_leaf(std::move(leaves[0].first), leaves[0].second);
+                continue;
+            }
+
+            RecordReader result{results.paths[i]};
+            uint8_t header[kResultHeaderLength];
+            result.read(header, sizeof(header));
+            if (header[0] != NodeRef::kMaxLength) {
+                // Embedded branch nodes can't be added by hash.
+                // Anyway they have very few leaves and no stored children.
+                for (auto &[key, value] : read_leaves(leaves_file, shard)) {
+                    hb.add_leaf(std::move(key), value);
+                }
+                continue;
+            }
+            evmc::bytes32 hash;
+            std::memcpy(hash.bytes, &header[2], kHashLength);  // past the length and the RLP string header
+            const bool is_in_db_trie{header[kResultHeaderLength - 1] != 0};
+            hb.add_branch_node(unpack_nibbles(shard.first_key).substr(0, shard.prefix_length()), hash, is_in_db_trie);
+
+            // Nodes of the preceding subtries, if any, have been closed by the addition above
+            if (collect_nodes) {
+                while (result.next()) {
+                    Node node;
+                    if (!Node::decode_from_storage(result.value(), node)) {
+                        throw_io_error("can't decode a node of", results.paths[i]);
+                    }
+                    node_collector(result.key(), node);
+                }
+            }
+        }
+        return hb.root_hash();
+    }
+
+}  // namespace silkworm::trie
+
+silkworm_ShardedRootCoordinator *silkworm_ShardedRootCoordinator_new(size_t num_processes, size_t split_nibbles,
+                                                                     const char *work_dir) {
+    return reinterpret_cast<silkworm_ShardedRootCoordinator *>(new silkworm::trie::ShardedRootCoordinator(
+            num_processes, split_nibbles, work_dir ? std::filesystem::path{work_dir} : std::filesystem::path{}));
+}
+
+void silkworm_ShardedRootCoordinator_free(silkworm_ShardedRootCoordinator *coordinator) {
+    delete reinterpret_cast<silkworm::trie::ShardedRootCoordinator *>(coordinator);
+}
+
+int silkworm_ShardedRootCoordinator_root_hash(silkworm_ShardedRootCoordinator *coordinator, const char *leaves_file,
+                                              uint8_t out_hash[32]) {
+    auto cpp_coordinator = reinterpret_cast<silkworm::trie::ShardedRootCoordinator *>(coordinator);
+    try {
+        const evmc::bytes32 root{cpp_coordinator->root_hash(leaves_file)};
+        std::memcpy(out_hash, root.bytes, 32);
+    } catch (const std::exception &) {
+        return 0;
+    }
+    return 1;
+}
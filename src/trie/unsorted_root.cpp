@@ -0,0 +1,200 @@
+#include "merkle-patricia-tree/trie/unsorted_root.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "merkle-patricia-tree/trie/hash_builder.hpp"
+#include "merkle-patricia-tree/trie/nibbles.hpp"
+#include "merkle-patricia-tree/trie/parallel_hash_builder.hpp"
+
+namespace silkworm::trie {
+
+    namespace {
+
+        using Entry = std::pair<ByteView, ByteView>;
+
+        // Below that, a comparison sort beats a counting pass over 17 buckets
+        constexpr size_t kComparisonSortThreshold{64};
+
+        // Entries partitioned per task of the leading pass
+        constexpr size_t kPartitionChunk{1u << 16};
+
+        // Below that, building the subtries in parallel doesn't pay for unpacking their keys
+        constexpr size_t kParallelThreshold{4096};
+
+        // 0 if the key has no nibble at digit, 1 + that nibble otherwise
+        size_t bucket_of(ByteView key, size_t digit) noexcept {
+            const size_t pos{digit / 2};
+            if (pos >= key.length()) {
+                return 0;
+            }
+            return 1u + ((digit & 1) ? (key[pos] & 0x0f) : (key[pos] >> 4));
+        }
+
+        // Sorts entries whose keys share their leading digit nibbles, with buffer (of the same size) as scratch
+        void sort_from(std::span<Entry> entries, std::span<Entry> buffer, size_t digit) {
+            for (;; ++digit) {
+                if (entries.size() <= kComparisonSortThreshold) {
+                    // Every key has at least digit nibbles, so the shared bytes can be skipped
+                    const size_t skip{digit / 2};
+                    std::sort(entries.begin(), entries.end(), [skip](const Entry &a, const Entry &b) {
+                        return a.first.substr(skip) < b.first.substr(skip);
+                    });
+                    return;
+                }
+
+                std::array<size_t, 18> begin{};
+                for (const Entry &entry : entries) {
+                    ++begin[bucket_of(entry.first, digit) + 1];
+                }
+                const auto full{std::find(begin.begin(), begin.end(), entries.size())};
+                if (full != begin.end()) {
+                    if (full == begin.begin() + 1) {
+                        return;  // all the keys end here, i.e. are equal
+                    }
+                    continue;  // a nibble shared by all the keys, e.g. within an extension
+                }
+                for (size_t b{1}; b < begin.size(); ++b) {
+                    begin[b] += begin[b - 1];
+                }
+
+                std::array<size_t, 17> next{};
+                std::copy_n(begin.begin(), next.size(), next.begin());
+                for (const Entry &entry : entries) {
+                    buffer[next[bucket_of(entry.first, digit)]++] = entry;
+                }
+                std::copy(buffer.begin(), buffer.end(), entries.begin());
+
+                for (size_t b{1}; b < next.size(); ++b) {
+                    const size_t size{begin[b + 1] - begin[b]};
+                    if (size > 1) {
+                        sort_from(entries.subspan(begin[b], size), buffer.subspan(begin[b], size), digit + 1);
+                    }
+                }
+                return;
+            }
+        }
+
+        // Rejects the keys HashBuilder asserts on, before choosing whether to build the subtries in parallel
+        void check_sorted_keys(std::span<const Entry> sorted) {
+            for (size_t i{0}; i < sorted.size(); ++i) {
+                const ByteView key{sorted[i].first};
+                if (key.empty()) {
+                    throw std::invalid_argument{"unsorted_root_hash: empty key"};
+                }
+                // A key prefix of another one is also prefix of the keys sorted in between
+                if (i + 1 < sorted.size() && sorted[i + 1].first.starts_with(key)) {
+                    throw std::invalid_argument{sorted[i + 1].first == key ? "unsorted_root_hash: duplicate key"
+                                                                            : "unsorted_root_hash: key prefix of another"};
+                }
+            }
+        }
+
+    }  // namespace
+
+    RadixBuckets radix_sort(std::span<std::pair<ByteView, ByteView>> entries, ThreadPool *pool) {
+        const size_t count{entries.size()};
+        std::vector<Entry> buffer(count);
+
+        // Leading pass: each chunk counts its own entries per bucket, then scatters them at its own offsets
+        const size_t num_chunks{pool ? std::max<size_t>((count + kPartitionChunk - 1) / kPartitionChunk, 1) : 1};
+        const size_t chunk{num_chunks == 1 ? count : kPartitionChunk};
+        std::vector<std::array<size_t, 17>> offsets(num_chunks);
+        for_each_chunk(count, chunk, pool, [&](size_t first, size_t last) {
+            std::array<size_t, 17> &counts{offsets[first / std::max<size_t>(chunk, 1)]};
+            for (size_t i{first}; i < last; ++i) {
+                ++counts[bucket_of(entries[i].first, 0)];
+            }
+        });
+        std::array<size_t, 18> begin{};
+        size_t total{0};
+        for (size_t b{0}; b < 17; ++b) {
+            begin[b] = total;
+            for (auto &counts : offsets) {
+                total += std::exchange(counts[b], total);
+            }
+        }
+        begin[17] = total;
+        for_each_chunk(count, chunk, pool, [&](size_t first, size_t last) {
+            std::array<size_t, 17> &next{offsets[first / std::max<size_t>(chunk, 1)]};
+            for (size_t i{first}; i < last; ++i) {
+                buffer[next[bucket_of(entries[i].first, 0)]++] = entries[i];
+            }
+        });
+
+        // Buckets are sorted independently, each moving back its own entries first
+        for_each_chunk(17, 1, count > kComparisonSortThreshold ? pool : nullptr, [&](size_t first, size_t last) {
+            for (size_t b{first}; b < last; ++b) {
+                const size_t size{begin[b + 1] - begin[b]};
+                std::copy_n(buffer.begin() + static_cast<ptrdiff_t>(begin[b]), size,
+                            entries.begin() + static_cast<ptrdiff_t>(begin[b]));
+                if (b > 0 && size > 1) {
+                    sort_from(entries.subspan(begin[b], size), std::span{buffer}.subspan(begin[b], size), 1);
+                }
+            }
+        });
+
+        RadixBuckets buckets;
+        std::copy_n(begin.begin() + 1, buckets.size(), buckets.begin());
+        return buckets;
+    }
+
+    evmc::bytes32 unsorted_root_hash(std::span<const std::pair<ByteView, ByteView>> entries, ThreadPool *pool) {
+        std::vector<Entry> sorted(entries.begin(), entries.end());
+        const RadixBuckets buckets{radix_sort(sorted, pool)};
+        check_sorted_keys(sorted);
+
+        if (!pool || sorted.size() < kParallelThreshold) {
+            // Keys and values outlive the builder, hence are borrowed
+            HashBuilderT<NoCollector> hb;
+            for (const auto &[key, value] : sorted) {
+                hb.add_leaf_borrowed(PackedNibbles{key}, value);
+            }
+            return hb.root_hash();
+        }
+
+        // The buckets of the leading nibble are the subtries below the root, none being empty keys
+        std::vector<std::future<Subtrie>> subtries;
+        for (size_t b{0}; b < 16; ++b) {
+            if (buckets[b] == buckets[b + 1]) {
+                continue;
+            }
+            subtries.push_back(pool->submit([&sorted, first{buckets[b]}, last{buckets[b + 1]}] {
+                std::vector<std::pair<Bytes, Bytes>> leaves;
+                leaves.reserve(last - first);
+                for (size_t i{first}; i < last; ++i) {
+                    leaves.emplace_back(unpack_nibbles(sorted[i].first), sorted[i].second);
+                }
+                return build_subtrie(std::move(leaves), /*collect_nodes=*/false);
+            }));
+        }
+        HashBuilder hb;
+        for (auto &future : subtries) {
+            Subtrie subtrie{future.get()};
+            fold_subtrie(hb, subtrie);
+        }
+        return hb.root_hash();
+    }
+
+}  // namespace silkworm::trie
+
+int silkworm_trie_unsorted_root_hash(uint8_t out_hash[32], const silkworm_ByteView *keys,
+                                     const silkworm_ByteView *values, size_t count) {
+    std::vector<std::pair<silkworm::ByteView, silkworm::ByteView>> entries;
+    entries.reserve(count);
+    for (size_t i{0}; i < count; ++i) {
+        entries.emplace_back(silkworm::ByteView{keys[i].data, keys[i].length},
+                             silkworm::ByteView{values[i].data, values[i].length});
+    }
+    try {
+        const evmc::bytes32 root{silkworm::trie::unsorted_root_hash(entries)};
+        std::memcpy(out_hash, root.bytes, 32);
+    } catch (const std::invalid_argument &) {
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,56 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/util.hpp>
+
+namespace silkworm {
+
+TEST_CASE("keccak256_batch") {
+    // Lengths around the 136-byte rate, up to a full branch node, in mixed order
+    std::vector<Bytes> data;
+    for (size_t length : {0u, 1u, 31u, 32u, 33u, 135u, 136u, 137u, 200u, 271u, 272u, 273u, 532u}) {
+        for (size_t copy{0}; copy < 11; ++copy) {
+            Bytes input(length, 0);
+            for (size_t i{0}; i < length; ++i) {
+                input[i] = static_cast<uint8_t>(i * 7 + copy * 13 + length);
+            }
+            data.push_back(std::move(input));
+        }
+    }
+    for (size_t i{0}; i + 1 < data.size(); i += 3) {
+        std::swap(data[i], data[data.size() - 1 - i]);
+    }
+    const std::vector<ByteView> inputs(data.begin(), data.end());
+
+    for (const auto backend : {KeccakBackend::kScalar, KeccakBackend::kAvx2, KeccakBackend::kAvx512}) {
+        if (backend > keccak256_batch_backend()) {
+            continue;
+        }
+        for (size_t count : {size_t{0}, size_t{1}, size_t{5}, size_t{9}, inputs.size()}) {
+            std::vector<ethash::hash256> outputs(count);
+            keccak256_batch(std::span{inputs}.first(count), outputs, backend);
+            for (size_t i{0}; i < count; ++i) {
+                CHECK(to_hex(outputs[i].bytes) == to_hex(keccak256(inputs[i]).bytes));
+            }
+        }
+    }
+}
+
+}  // namespace silkworm
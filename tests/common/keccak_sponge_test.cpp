@@ -0,0 +1,52 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/keccak_sponge.hpp>
+#include <merkle-patricia-tree/common/util.hpp>
+
+namespace silkworm {
+
+TEST_CASE("KeccakSponge") {
+    Bytes data(600, 0);
+    for (size_t i{0}; i < data.length(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+
+    KeccakSponge sponge;
+    CHECK(to_hex(sponge.finalize().bytes) == to_hex(keccak256({}).bytes));
+
+    for (size_t length : {1u, 7u, 8u, 135u, 136u, 137u, 272u, 532u, 600u}) {
+        const ByteView input{ByteView{data}.substr(0, length)};
+        const std::string expected{to_hex(keccak256(input).bytes)};
+
+        // Pieces of all sizes, so that they straddle words and blocks
+        for (size_t piece_length : {1u, 3u, 8u, 33u, 136u, 600u}) {
+            for (size_t i{0}; i < length; i += piece_length) {
+                sponge.absorb(input.substr(i, piece_length));
+            }
+            CHECK(to_hex(sponge.finalize().bytes) == expected);
+        }
+
+        for (const uint8_t byte : input) {
+            sponge.absorb(byte);
+        }
+        CHECK(to_hex(sponge.finalize().bytes) == expected);
+    }
+}
+
+}  // namespace silkworm
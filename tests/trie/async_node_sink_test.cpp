@@ -0,0 +1,134 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/trie/async_node_sink.hpp>
+#include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/nibbles.hpp>
+
+namespace silkworm::trie {
+
+namespace {
+
+    using StoredNodes = std::vector<std::pair<Bytes, Bytes>>;
+
+    // Leaves of a trie with many stored nodes
+    std::map<Bytes, Bytes> sample_leaves() {
+        std::mt19937_64 rng{42};
+        std::map<Bytes, Bytes> leaves;
+        while (leaves.size() < 5'000) {
+            Bytes key(kHashLength, 0);
+            for (auto& b : key) {
+                b = static_cast<uint8_t>(rng());
+            }
+            leaves.emplace(std::move(key), Bytes(kHashLength, static_cast<uint8_t>(rng())));
+        }
+        return leaves;
+    }
+
+    evmc::bytes32 build(const std::map<Bytes, Bytes>& leaves, NodeCollector collector) {
+        HashBuilder hb;
+        hb.node_collector = std::move(collector);
+        for (const auto& [key, value] : leaves) {
+            hb.add_leaf(unpack_nibbles(key), value);
+        }
+        return hb.root_hash();
+    }
+
+    void append(StoredNodes& stored, const CollectedNodes& batch) {
+        for (size_t i{0}; i < batch.size(); ++i) {
+            stored.emplace_back(batch.key(i), batch.node(i));
+        }
+    }
+
+}  // namespace
+
+TEST_CASE("AsyncNodeSink") {
+    const std::map<Bytes, Bytes> leaves{sample_leaves()};
+    StoredNodes expected;
+    const evmc::bytes32 root{build(leaves, [&](ByteView nibbled_key, const Node& node) {
+        expected.emplace_back(nibbled_key, node.encode_for_storage());
+    })};
+    REQUIRE(expected.size() > 100);
+
+    SECTION("Batches written in order") {
+        StoredNodes stored;
+        size_t num_batches{0};
+        size_t max_batch_size{0};
+        // Assertions aren't thread-safe, hence the writer only records
+        AsyncNodeSink sink{[&](const CollectedNodes& batch) {
+                               append(stored, batch);
+                               ++num_batches;
+                               max_batch_size = std::max(max_batch_size, batch.size());
+                           },
+                           /*batch_size=*/7};
+        CHECK(build(leaves, sink.collector()) == root);
+        sink.flush();
+        CHECK(sink.pending_batches() == 0);
+        CHECK(num_batches == (expected.size() + 6) / 7);
+        CHECK(max_batch_size == 7);
+        CHECK(stored == expected);
+    }
+
+    SECTION("Back pressure of a slow writer") {
+        StoredNodes stored;
+        AsyncNodeSink sink{[&](const CollectedNodes& batch) {
+                               std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                               append(stored, batch);
+                           },
+                           /*batch_size=*/4, /*num_batches=*/2};
+        CHECK(build(leaves, sink.collector()) == root);
+        sink.flush();
+        CHECK(sink.stalls() > 0);
+        CHECK(stored == expected);
+    }
+
+    SECTION("Nodes left are written on destruction") {
+        StoredNodes stored;
+        {
+            AsyncNodeSink sink{[&](const CollectedNodes& batch) { append(stored, batch); }};
+            build(leaves, sink.collector());
+        }
+        CHECK(stored == expected);
+    }
+
+    SECTION("Writer failure") {
+        size_t num_batches{0};
+        AsyncNodeSink sink{[&](const CollectedNodes&) {
+                               if (++num_batches == 2) {
+                                   throw std::runtime_error{"disk full"};
+                               }
+                           },
+                           /*batch_size=*/1};
+        sink(expected[0].first, Node{});
+        sink(expected[1].first, Node{});
+        CHECK_THROWS_AS(sink.flush(), std::runtime_error);
+        CHECK_THROWS_AS(sink(expected[2].first, Node{}), std::runtime_error);
+        CHECK(num_batches == 2);
+    }
+}
+
+}  // namespace silkworm::trie
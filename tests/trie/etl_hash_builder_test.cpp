@@ -0,0 +1,137 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <map>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/empty_hashes.hpp>
+#include <merkle-patricia-tree/trie/etl_hash_builder.hpp>
+#include <merkle-patricia-tree/types/evmc_bytes32.hpp>
+
+#include "test_util.hpp"
+
+namespace silkworm::trie {
+
+TEST_CASE("EtlHashBuilder of no leaves") {
+    test::TemporaryDirectory dir{"mpt-etl-hash-builder-test"};
+    EtlHashBuilder etl{dir.path};
+    CHECK(etl.root_hash() == kEmptyRoot);
+}
+
+TEST_CASE("EtlHashBuilder") {
+    test::TemporaryDirectory dir{"mpt-etl-hash-builder-test"};
+    std::mt19937_64 rng{42};
+
+    const std::map<Bytes, Bytes> sorted{test::random_leaves(10'000, rng)};
+    const auto [expected_root, expected_nodes]{test::reference_trie(sorted)};
+
+    std::vector<std::pair<ByteView, ByteView>> leaves(sorted.begin(), sorted.end());
+    std::shuffle(leaves.begin(), leaves.end(), rng);
+
+    SECTION("Within the buffer") {
+        EtlHashBuilder etl{dir.path};
+        for (const auto& [key, value] : leaves) {
+            etl.add_leaf(key, value);
+        }
+        CHECK(etl.num_runs() == 0);
+        CHECK(dir.empty());
+        CHECK(etl.root_hash() == expected_root);
+    }
+
+    SECTION("Spilled into runs") {
+        // Leaves of about 60 bytes plus 80 of bookkeeping, i.e. about 450 per run and the rest merged from the buffer
+        EtlHashBuilder etl{dir.path, 64 * 1'000};
+        std::vector<std::pair<Bytes, Node>> nodes;
+        etl.node_collector = [&](ByteView nibbled_key, const Node& node) { nodes.emplace_back(nibbled_key, node); };
+        for (const auto& [key, value] : leaves) {
+            etl.add_leaf(key, value);
+        }
+        CHECK(etl.num_runs() > 5);
+        CHECK(!dir.empty());
+
+        CHECK(etl.root_hash() == expected_root);
+        CHECK(nodes == expected_nodes);
+
+        // Emptied along with the run files
+        CHECK(etl.num_runs() == 0);
+        CHECK(dir.empty());
+        CHECK(etl.root_hash() == kEmptyRoot);
+    }
+
+    SECTION("More runs than merged at once") {
+        for (const size_t max_merge_width : {2u, 3u, 16u}) {
+            EtlHashBuilder etl{dir.path, 64 * 1'000, /*pool=*/nullptr, max_merge_width};
+            std::vector<std::pair<Bytes, Node>> nodes;
+            etl.node_collector = [&](ByteView nibbled_key, const Node& node) { nodes.emplace_back(nibbled_key, node); };
+            for (const auto& [key, value] : leaves) {
+                etl.add_leaf(key, value);
+            }
+            REQUIRE(etl.num_runs() > max_merge_width);
+
+            CHECK(etl.root_hash() == expected_root);
+            CHECK(nodes == expected_nodes);
+            CHECK(dir.empty());
+        }
+    }
+
+    SECTION("Reset") {
+        EtlHashBuilder etl{dir.path, 64 * 1'000};
+        for (const auto& [key, value] : leaves) {
+            etl.add_leaf(key, value);
+        }
+        etl.reset();
+        CHECK(dir.empty());
+        for (const auto& [key, value] : leaves) {
+            etl.add_leaf(key, value);
+        }
+        CHECK(etl.root_hash() == expected_root);
+    }
+
+    SECTION("Cut run files") {
+        // Within the header of the first record, then within the value of the last one
+        for (const bool within_header : {true, false}) {
+            EtlHashBuilder etl{dir.path, 64 * 1'000};
+            for (const auto& [key, value] : leaves) {
+                etl.add_leaf(key, value);
+            }
+            const std::filesystem::path run{std::filesystem::directory_iterator{dir.path}->path()};
+            std::filesystem::resize_file(run, within_header ? 3 : std::filesystem::file_size(run) - 1);
+            CHECK_THROWS_AS(etl.root_hash(), std::runtime_error);
+            etl.reset();
+            CHECK(dir.empty());
+        }
+    }
+
+    SECTION("Run files are removed by the destructor") {
+        {
+            EtlHashBuilder etl{dir.path, 64 * 1'000};
+            for (const auto& [key, value] : leaves) {
+                etl.add_leaf(key, value);
+            }
+            CHECK(!dir.empty());
+        }
+        CHECK(dir.empty());
+    }
+}
+
+}  // namespace silkworm::trie
@@ -1,8 +1,11 @@
+#include <algorithm>
+#include <bit>
 #include <iterator>
 #include <ethash/keccak.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <merkle-patricia-tree/common/util.hpp>
 #include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/hash_builder_impl.hpp>
 #include <merkle-patricia-tree/trie/nibbles.hpp>
 #include <merkle-patricia-tree/types/evmc_bytes32.hpp>
 #include <merkle-patricia-tree/common/empty_hashes.hpp>
@@ -179,4 +182,358 @@ TEST_CASE("HashBuilder3") {
         CHECK(to_hex(hb.root_hash()) == to_hex(root_hash.bytes));
     }
 
+    TEST_CASE("Branch nodes of hashes") {
+        for (const uint16_t state_mask : {0b11, 0b1000'0000'0000'0001, 0b0110'1001'0000'1100, 0xffff}) {
+            HashBuilder hb;
+            Bytes expected_payload;
+            for (uint8_t digit{0}; digit < 16; ++digit) {
+                if (state_mask & (1u << digit)) {
+                    const ethash::hash256 child_hash{keccak256(Bytes{digit})};
+                    hb.add_branch_node(Bytes{digit}, std::bit_cast<evmc::bytes32>(child_hash));
+                    expected_payload.push_back(rlp::kEmptyStringCode + kHashLength);
+                    expected_payload.append(child_hash.bytes, kHashLength);
+                } else {
+                    expected_payload.push_back(rlp::kEmptyStringCode);
+                }
+            }
+            expected_payload.push_back(rlp::kEmptyStringCode);
+
+            Bytes expected_rlp;
+            rlp::encode_header(expected_rlp, {.list = true, .payload_length = expected_payload.length()});
+            expected_rlp.append(expected_payload);
+            CHECK(to_hex(hb.root_hash()) == to_hex(keccak256(expected_rlp).bytes));
+        }
+    }
+
+    TEST_CASE("Packed keys") {
+        // Odd & even key lengths, so that short node paths begin on either nibble of a byte
+        const std::vector<std::string> keys{"0102", "010304", "0103050607", "0103050608", "01030600", "0a",
+                                            "0b000102030405", "0b0001020306", "0f0e0d0c0b0a09080706050403020100"};
+        std::vector<std::pair<Bytes, Bytes>> unpacked_collected;
+        std::vector<std::pair<Bytes, Bytes>> packed_collected;
+
+        HashBuilder unpacked;
+        HashBuilder packed;
+        unpacked.node_collector = [&](ByteView nibbled_key, const Node& node) {
+            unpacked_collected.emplace_back(nibbled_key, node.encode_for_storage());
+        };
+        packed.node_collector = [&](ByteView nibbled_key, const Node& node) {
+            packed_collected.emplace_back(nibbled_key, node.encode_for_storage());
+        };
+        for (const auto& hex : keys) {
+            const Bytes key{*from_hex(hex)};
+            const Bytes value(20, key.back());
+            unpacked.add_leaf(key, value);
+            packed.add_leaf(PackedNibbles{pack_nibbles(key), (key.length() & 1) != 0}, value);
+        }
+        CHECK(to_hex(packed.root_hash()) == to_hex(unpacked.root_hash()));
+        CHECK(packed_collected == unpacked_collected);
+    }
+
+    TEST_CASE("Borrowed leaves") {
+        // Keys & values stay in place for the lifetime of the builder, just like a memory-mapped file
+        std::vector<std::pair<Bytes, Bytes>> leaves;
+        for (uint8_t i{0}; i < 200; i += 7) {
+            leaves.emplace_back(Bytes{i, static_cast<uint8_t>(i * 3)}, Bytes(1 + i % 40, i));
+        }
+
+        HashBuilder copied;
+        HashBuilder borrowed;
+        for (const auto& [key, value] : leaves) {
+            copied.add_leaf(PackedNibbles{key}, value);
+            borrowed.add_leaf_borrowed(PackedNibbles{key}, value);
+        }
+        CHECK(to_hex(borrowed.root_hash()) == to_hex(copied.root_hash()));
+    }
+
+    // Collector known at compile time
+    struct CountingCollector {
+        size_t* count;
+        void operator()(ByteView, const Node&) const { ++*count; }
+    };
+
+    TEST_CASE("Collector policies") {
+        std::vector<Bytes> keys;
+        for (uint8_t i{0}; i < 100; ++i) {
+            keys.push_back(unpack_nibbles(keccak256(Bytes{i}).bytes));
+        }
+        std::sort(keys.begin(), keys.end());
+
+        HashBuilder hb;
+        size_t expected_count{0};
+        hb.node_collector = [&expected_count](ByteView, const Node&) { ++expected_count; };
+        HashBuilderT<NoCollector> no_collector;
+        size_t count{0};
+        HashBuilderT<CountingCollector> counting;
+        counting.node_collector = CountingCollector{&count};
+
+        for (const auto& key : keys) {
+            hb.add_leaf(key, key);
+            no_collector.add_leaf(key, key);
+            counting.add_leaf(key, key);
+        }
+        const evmc::bytes32 expected_root{hb.root_hash()};
+        CHECK(no_collector.root_hash() == expected_root);
+        CHECK(counting.root_hash() == expected_root);
+        CHECK(expected_count > 0);
+        CHECK(count == expected_count);
+    }
+
+    TEST_CASE("Fixed-length keys") {
+        std::vector<Bytes> keys;
+        for (uint16_t i{0}; i < 1'000; ++i) {
+            keys.push_back(unpack_nibbles(keccak256(Bytes{static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8)}).bytes));
+        }
+        // Keys sharing long prefixes, down to differing in the last nibble only
+        for (size_t shared : {7u, 16u, 31u, 32u, 47u, 63u}) {
+            Bytes key{keys[0]};
+            key[shared] ^= 0x01;
+            keys.push_back(std::move(key));
+        }
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<std::pair<Bytes, Bytes>> expected_nodes;
+        std::vector<std::pair<Bytes, Bytes>> nodes;
+        HashBuilder hb;
+        hb.node_collector = [&expected_nodes](ByteView key, const Node& node) {
+            expected_nodes.emplace_back(key, node.encode_for_storage());
+        };
+        HashedKeyHashBuilder<> fixed;
+        fixed.node_collector = [&nodes](ByteView key, const Node& node) {
+            nodes.emplace_back(key, node.encode_for_storage());
+        };
+        HashedKeyHashBuilder<NoCollector> fixed_no_collector;
+
+        for (const auto& key : keys) {
+            hb.add_leaf(key, key);
+            fixed.add_leaf(PackedNibbles{pack_nibbles(key)}, key);
+            fixed_no_collector.add_leaf(key, key);
+        }
+        const evmc::bytes32 expected_root{hb.root_hash()};
+        CHECK(to_hex(fixed.root_hash()) == to_hex(expected_root));
+        CHECK(to_hex(fixed_no_collector.root_hash()) == to_hex(expected_root));
+        CHECK(nodes == expected_nodes);
+
+        // Shorter keys of branch nodes are fine too
+        static constexpr auto branch_hash{0x9fa752911d55c3a1246133fe280785afbdba41f357e9cae1131d5f5b0a078b9c_bytes32};
+        hb.reset();
+        fixed.reset();
+        hb.add_leaf(keys[0], keys[0]);
+        hb.add_branch_node(*from_hex("0f0e"), branch_hash);
+        fixed.add_leaf(keys[0], keys[0]);
+        fixed.add_branch_node(*from_hex("0f0e"), branch_hash);
+        CHECK(to_hex(fixed.root_hash()) == to_hex(hb.root_hash()));
+    }
+
+    TEST_CASE("Proofs") {
+        std::vector<std::pair<Bytes, Bytes>> leaves;
+        for (uint16_t i{0}; i < 500; ++i) {
+            const Bytes key{unpack_nibbles(keccak256(Bytes{static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8)}).bytes)};
+            leaves.emplace_back(key, Bytes(1 + i % 40, static_cast<uint8_t>(i)));
+        }
+        std::sort(leaves.begin(), leaves.end());
+
+        // Present keys plus absent ones, ending either within a leaf path or next to an empty branch slot
+        PrefixSet targets;
+        std::vector<Bytes> present;
+        for (size_t i{0}; i < leaves.size(); i += 61) {
+            present.push_back(leaves[i].first);
+            targets.insert(leaves[i].first);
+        }
+        std::vector<Bytes> absent{Bytes(64, 0x0), Bytes(64, 0xf), leaves[7].first};
+        absent.back().back() ^= 0x1;
+        for (const auto& key : absent) {
+            targets.insert(key);
+        }
+
+        HashBuilder expected;
+        HashBuilder hb;
+        hb.proof_retainer.emplace(targets);
+        for (const auto& [key, value] : leaves) {
+            expected.add_leaf(key, value);
+            hb.add_leaf(key, value);
+        }
+        const evmc::bytes32 root{hb.root_hash()};
+        CHECK(root == expected.root_hash());
+
+        // Each node is referenced by its hash from its parent, the root by the root hash
+        const auto check_links{[&root](const std::vector<Bytes>& proof) {
+            REQUIRE(!proof.empty());
+            CHECK(to_hex(keccak256(proof[0]).bytes) == to_hex(root));
+            for (size_t i{1}; i < proof.size(); ++i) {
+                Bytes ref{rlp::kEmptyStringCode + kHashLength};
+                ref.append(keccak256(proof[i]).bytes, kHashLength);
+                CHECK(proof[i - 1].find(ref) != Bytes::npos);
+            }
+        }};
+        for (const auto& key : present) {
+            const std::vector<Bytes> proof{hb.proof_retainer->proof(key)};
+            check_links(proof);
+            const auto leaf{std::lower_bound(leaves.begin(), leaves.end(), std::make_pair(key, Bytes{}))};
+            CHECK(proof.back().ends_with(leaf->second));
+        }
+        for (const auto& key : absent) {
+            check_links(hb.proof_retainer->proof(key));
+        }
+
+        // Only the nodes on the paths to the targets are retained
+        for (const auto& [path, _] : hb.proof_retainer->nodes()) {
+            const auto is_on_path{[&path](const Bytes& key) { return key.starts_with(path); }};
+            CHECK((std::any_of(present.begin(), present.end(), is_on_path) ||
+                   std::any_of(absent.begin(), absent.end(), is_on_path)));
+        }
+    }
+
+    TEST_CASE("Full-node RLP collector") {
+        std::vector<std::pair<Bytes, Bytes>> leaves;
+        for (uint16_t i{0}; i < 500; ++i) {
+            const Bytes key{unpack_nibbles(keccak256(Bytes{static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8)}).bytes)};
+            leaves.emplace_back(key, Bytes(1 + i % 40, static_cast<uint8_t>(i)));
+        }
+        std::sort(leaves.begin(), leaves.end());
+
+        struct CollectedNode {
+            Bytes path;
+            Bytes rlp;
+            NodeRef ref;
+        };
+        std::vector<CollectedNode> collected;
+        HashBuilder expected;
+        HashBuilder hb;
+        hb.rlp_collector = [&collected](PackedNibbles path, ByteView rlp, const NodeRef& ref) {
+            Bytes nibbled_path(path.length(), 0);
+            for (size_t i{0}; i < path.length(); ++i) {
+                nibbled_path[i] = path[i];
+            }
+            collected.push_back({std::move(nibbled_path), Bytes{rlp}, ref});
+        };
+        // Proofs of all the leaves, i.e. all the nodes
+        PrefixSet targets;
+        for (const auto& [key, value] : leaves) {
+            targets.insert(key);
+        }
+        hb.proof_retainer.emplace(targets);
+        for (const auto& [key, value] : leaves) {
+            expected.add_leaf(key, value);
+            hb.add_leaf(key, value);
+        }
+        const evmc::bytes32 root{hb.root_hash()};
+        CHECK(root == expected.root_hash());
+
+        // The root last, once its children are
+        REQUIRE(!collected.empty());
+        CHECK(collected.back().path.empty());
+        CHECK(collected.back().ref.node_hash() == root);
+
+        size_t num_leaves{0};
+        for (const CollectedNode& node : collected) {
+            CHECK(node.ref == NodeRef::from_rlp(node.rlp));
+            // Every node once, as retained for the proofs
+            const auto retained{hb.proof_retainer->nodes().find(node.path)};
+            REQUIRE(retained != hb.proof_retainer->nodes().end());
+            CHECK(retained->second == node.rlp);
+            const auto leaf{std::lower_bound(leaves.begin(), leaves.end(), std::make_pair(node.path, Bytes{}))};
+            if (leaf != leaves.end() && leaf->first.starts_with(node.path) && node.rlp.ends_with(leaf->second)) {
+                ++num_leaves;
+            }
+        }
+        CHECK(collected.size() == hb.proof_retainer->nodes().size());
+        CHECK(num_leaves >= leaves.size());
+
+        // Unset, nodes are hashed on the fly again with the same outcome
+        hb.reset();
+        hb.rlp_collector = nullptr;
+        collected.clear();
+        for (const auto& [key, value] : leaves) {
+            hb.add_leaf(key, value);
+        }
+        CHECK(hb.root_hash() == root);
+        CHECK(collected.empty());
+    }
+
+    TEST_CASE("Checkpoints") {
+        std::vector<std::pair<Bytes, Bytes>> leaves;
+        for (uint16_t i{0}; i < 1000; ++i) {
+            const Bytes key{keccak256(Bytes{static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8)}).bytes, kHashLength};
+            leaves.emplace_back(key, Bytes(1 + i % 40, static_cast<uint8_t>(i)));
+        }
+        std::sort(leaves.begin(), leaves.end());
+
+        std::vector<std::pair<Bytes, Node>> expected_nodes;
+        HashBuilder expected;
+        expected.node_collector = [&](ByteView nibbled_key, const Node& node) {
+            expected_nodes.emplace_back(nibbled_key, node);
+        };
+        for (const auto& [key, value] : leaves) {
+            expected.add_leaf(PackedNibbles{key}, value);
+        }
+        const evmc::bytes32 root{expected.root_hash()};
+
+        SECTION("Resumed by another builder after each leaf") {
+            std::vector<std::pair<Bytes, Node>> nodes;
+            Bytes checkpoint{HashBuilder{}.save_checkpoint()};
+            for (const auto& [key, value] : leaves) {
+                HashBuilder hb;
+                hb.node_collector = [&](ByteView nibbled_key, const Node& node) { nodes.emplace_back(nibbled_key, node); };
+                REQUIRE(hb.load_checkpoint(checkpoint));
+                hb.add_leaf_borrowed(PackedNibbles{key}, value);
+                checkpoint = hb.save_checkpoint();
+            }
+            HashBuilder hb;
+            hb.node_collector = [&](ByteView nibbled_key, const Node& node) { nodes.emplace_back(nibbled_key, node); };
+            REQUIRE(hb.load_checkpoint(checkpoint));
+            CHECK(hb.root_hash() == root);
+            CHECK(nodes == expected_nodes);
+        }
+
+        SECTION("Fixed-length keys and branch nodes") {
+            const size_t half{leaves.size() / 2};
+            HashedKeyHashBuilder<NoCollector> hb;
+            for (size_t i{0}; i < half; ++i) {
+                hb.add_leaf(PackedNibbles{leaves[i].first}, leaves[i].second);
+            }
+            HashedKeyHashBuilder<NoCollector> resumed;
+            REQUIRE(resumed.load_checkpoint(hb.save_checkpoint()));
+            for (size_t i{half}; i < leaves.size(); ++i) {
+                resumed.add_leaf(PackedNibbles{leaves[i].first}, leaves[i].second);
+            }
+            CHECK(resumed.root_hash() == root);
+
+            const auto branch_hash{std::bit_cast<evmc::bytes32>(keccak256(Bytes{0x01}))};
+            HashBuilder with_branch;
+            with_branch.add_leaf(*from_hex("00"), *from_hex("01"));
+            with_branch.add_branch_node(*from_hex("0f"), branch_hash, /*is_in_db_trie=*/true);
+            HashBuilder restored;
+            REQUIRE(restored.load_checkpoint(with_branch.save_checkpoint()));
+            CHECK(restored.save_checkpoint() == with_branch.save_checkpoint());
+            CHECK(restored.root_hash() == with_branch.root_hash());
+        }
+
+        SECTION("Invalid checkpoints") {
+            HashBuilder hb;
+            for (size_t i{0}; i < 100; ++i) {
+                hb.add_leaf(PackedNibbles{leaves[i].first}, leaves[i].second);
+            }
+            const Bytes checkpoint{hb.save_checkpoint()};
+
+            HashBuilder other;
+            other.add_leaf(PackedNibbles{leaves[0].first}, leaves[0].second);
+            const Bytes before{other.save_checkpoint()};
+
+            CHECK(other.load_checkpoint(ByteView{checkpoint}.substr(0, checkpoint.length() - 1)).error() ==
+                  DecodingError::kInputTooShort);
+            CHECK(other.load_checkpoint(checkpoint + Bytes{0x00}).error() == DecodingError::kInputTooLong);
+            Bytes wrong_version{checkpoint};
+            wrong_version[0] = 0xff;
+            CHECK(other.load_checkpoint(wrong_version).error() == DecodingError::kInvalidFieldset);
+            CHECK(other.save_checkpoint() == before);
+
+            REQUIRE(other.load_checkpoint(checkpoint));
+            for (size_t i{100}; i < leaves.size(); ++i) {
+                other.add_leaf(PackedNibbles{leaves[i].first}, leaves[i].second);
+            }
+            CHECK(other.root_hash() == root);
+        }
+    }
+
 }  // namespace silkworm::trie
@@ -0,0 +1,96 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <map>
+#include <random>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/bytes_to_string.hpp>
+#include <merkle-patricia-tree/common/empty_hashes.hpp>
+#include <merkle-patricia-tree/common/util.hpp>
+#include <merkle-patricia-tree/trie/in_memory_trie.hpp>
+#include <merkle-patricia-tree/types/evmc_bytes32.hpp>
+
+#include "test_util.hpp"
+
+namespace silkworm::trie {
+
+TEST_CASE("InMemoryTrie empty") {
+    InMemoryTrie trie;
+    CHECK(trie.root_hash() == kEmptyRoot);
+    CHECK(trie.empty());
+    CHECK(!trie.get(string_view_to_byte_view("key")));
+    CHECK(!trie.erase(string_view_to_byte_view("key")));
+}
+
+// Keys being prefixes of one another end at branch nodes
+TEST_CASE("InMemoryTrie dogs") {
+    InMemoryTrie trie;
+    trie.put(string_view_to_byte_view("doe"), string_view_to_byte_view("reindeer"));
+    trie.put(string_view_to_byte_view("dog"), string_view_to_byte_view("puppy"));
+    trie.put(string_view_to_byte_view("dogglesworth"), string_view_to_byte_view("cat"));
+    CHECK(to_hex(trie.root_hash()) == "8aad789dff2f538bca5d8ea56e8abe10f4c7ba3a5dea95fea4cd6e7c3a1168d3");
+    CHECK(trie.size() == 3);
+    CHECK(trie.get(string_view_to_byte_view("dog")) == string_view_to_byte_view("puppy"));
+    CHECK(!trie.get(string_view_to_byte_view("do")));
+
+    trie.put(string_view_to_byte_view("dogglesworth"), {});
+    CHECK(trie.size() == 2);
+    CHECK(!trie.get(string_view_to_byte_view("dogglesworth")));
+    trie.erase(string_view_to_byte_view("doe"));
+    trie.erase(string_view_to_byte_view("dog"));
+    CHECK(trie.root_hash() == kEmptyRoot);
+}
+
+TEST_CASE("InMemoryTrie vs HashBuilder") {
+    std::mt19937_64 rng{42};
+    InMemoryTrie trie;
+    std::map<Bytes, Bytes> entries;
+
+    const auto random_key{[&rng](size_t length) {
+        Bytes key(length, 0);
+        for (auto& b : key) {
+            // few distinct bytes, so that keys share long prefixes
+            b = static_cast<uint8_t>(rng() % 4 * 0x11);
+        }
+        return key;
+    }};
+
+    for (const size_t key_length : {1u, 3u, 32u}) {
+        trie.clear();
+        entries.clear();
+        for (size_t batch{0}; batch < 50; ++batch) {
+            for (size_t op{0}; op < 1 + rng() % 20; ++op) {
+                const Bytes key{random_key(key_length)};
+                if (rng() % 3 == 0) {
+                    CHECK(trie.erase(key) == (entries.erase(key) == 1));
+                } else {
+                    const Bytes value{test::random_value(rng)};
+                    trie.put(key, value);
+                    entries.insert_or_assign(key, value);
+                }
+            }
+            REQUIRE(trie.size() == entries.size());
+            REQUIRE(trie.root_hash() == test::reference_root(entries));
+        }
+        for (const auto& [key, value] : entries) {
+            CHECK(trie.get(key) == ByteView{value});
+        }
+    }
+}
+
+}  // namespace silkworm::trie
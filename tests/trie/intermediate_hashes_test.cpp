@@ -0,0 +1,184 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/empty_hashes.hpp>
+#include <merkle-patricia-tree/common/endian.hpp>
+#include <merkle-patricia-tree/common/util.hpp>
+#include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/intermediate_hashes.hpp>
+#include <merkle-patricia-tree/trie/nibbles.hpp>
+#include <merkle-patricia-tree/types/evmc_bytes32.hpp>
+
+namespace silkworm::trie {
+
+using Table = std::map<Bytes, Bytes>;
+
+// Counts the entries read through another cursor
+class CountingCursor final : public KeyValueCursor {
+public:
+    explicit CountingCursor(KeyValueCursor& cursor) : cursor_{cursor} {}
+
+    std::optional<KeyValue> lower_bound(ByteView key) override { return count(cursor_.lower_bound(key)); }
+
+    std::optional<KeyValue> next() override { return count(cursor_.next()); }
+
+    void erase() override { cursor_.erase(); }
+
+    size_t reads{0};
+
+private:
+    std::optional<KeyValue> count(std::optional<KeyValue> entry) {
+        reads += entry.has_value() ? 1 : 0;
+        return entry;
+    }
+
+    KeyValueCursor& cursor_;
+};
+
+static Bytes hashed_key(uint64_t i) {
+    uint8_t index[8];
+    endian::store_big_u64(index, i);
+    return Bytes{keccak256(index).bytes, kHashLength};
+}
+
+// Builds the trie of the whole state from scratch
+static evmc::bytes32 full_build(const Table& state, Table& trie) {
+    HashBuilder hb;
+    hb.node_collector = [&trie](ByteView nibbled_key, const Node& node) {
+        trie.insert_or_assign(Bytes{nibbled_key}, node.encode_for_storage());
+    };
+    for (const auto& [key, value] : state) {
+        hb.add_leaf(PackedNibbles{key}, value);
+    }
+    return hb.root_hash();
+}
+
+static evmc::bytes32 incremental_build(Table& state, Table& trie, PrefixSet& changed, size_t& state_reads) {
+    MapCursor state_cursor{state};
+    CountingCursor counting_cursor{state_cursor};
+    MapCursor trie_cursor{trie};
+    TrieLoader loader{counting_cursor, trie_cursor};
+    Table collected;
+    loader.node_collector = [&collected](ByteView nibbled_key, const Node& node) {
+        collected.insert_or_assign(Bytes{nibbled_key}, node.encode_for_storage());
+    };
+    const evmc::bytes32 root{loader.calculate_root(changed)};
+    trie.merge(collected);
+    state_reads = counting_cursor.reads;
+    return root;
+}
+
+TEST_CASE("TrieLoader empty state") {
+    Table state;
+    Table trie;
+    PrefixSet changed;
+    size_t state_reads{0};
+    CHECK(incremental_build(state, trie, changed, state_reads) == kEmptyRoot);
+    CHECK(trie.empty());
+}
+
+TEST_CASE("TrieLoader without stored nodes") {
+    Table state;
+    for (uint64_t i{0}; i < 300; ++i) {
+        state.emplace(hashed_key(i), Bytes(1 + i % 40, static_cast<uint8_t>(i)));
+    }
+    Table expected_trie;
+    const evmc::bytes32 expected_root{full_build(state, expected_trie)};
+
+    Table trie;
+    PrefixSet changed;
+    size_t state_reads{0};
+    CHECK(incremental_build(state, trie, changed, state_reads) == expected_root);
+    CHECK(state_reads == state.size());
+    CHECK(trie == expected_trie);
+}
+
+TEST_CASE("TrieLoader incremental changes") {
+    Table state;
+    for (uint64_t i{0}; i < 3'000; ++i) {
+        state.emplace(hashed_key(i), Bytes(1 + i % 40, static_cast<uint8_t>(i)));
+    }
+    Table trie;
+    full_build(state, trie);
+
+    SECTION("No changes") {
+        const Table stored_trie{trie};
+        PrefixSet changed;
+        size_t state_reads{0};
+        Table expected_trie;
+        CHECK(incremental_build(state, trie, changed, state_reads) == full_build(state, expected_trie));
+        CHECK(state_reads == 0);
+        CHECK(trie == stored_trie);
+    }
+
+    SECTION("Updates, insertions and deletions") {
+        uint64_t next_index{state.size()};
+        for (size_t block{0}; block < 5; ++block) {
+            PrefixSet changed;
+            for (uint64_t i{block}; i < 3'000; i += 150) {
+                // update
+                const Bytes key{hashed_key(i)};
+                state.insert_or_assign(key, Bytes(33, static_cast<uint8_t>(block)));
+                changed.insert(unpack_nibbles(key));
+            }
+            for (size_t i{0}; i < 10; ++i) {
+                // insertion
+                const Bytes key{hashed_key(next_index++)};
+                state.insert_or_assign(key, Bytes(5, static_cast<uint8_t>(i)));
+                changed.insert(unpack_nibbles(key));
+            }
+            for (uint64_t i{100 + block}; i < 3'000; i += 300) {
+                // deletion
+                const Bytes key{hashed_key(i)};
+                state.erase(key);
+                changed.insert(unpack_nibbles(key));
+            }
+
+            size_t state_reads{0};
+            Table expected_trie;
+            const evmc::bytes32 expected_root{full_build(state, expected_trie)};
+            CHECK(incremental_build(state, trie, changed, state_reads) == expected_root);
+            CHECK(state_reads < state.size() / 2);
+            CHECK(trie == expected_trie);
+        }
+    }
+
+    SECTION("Deletion of all the leaves") {
+        PrefixSet changed;
+        for (const auto& [key, _] : state) {
+            changed.insert(unpack_nibbles(key));
+        }
+        state.clear();
+        size_t state_reads{0};
+        CHECK(incremental_build(state, trie, changed, state_reads) == kEmptyRoot);
+        CHECK(trie.empty());
+    }
+}
+
+TEST_CASE("increment_key") {
+    CHECK(increment_key({}) == std::nullopt);
+    CHECK(increment_key(*from_hex("0x000f")) == *from_hex("0x0100"));
+    CHECK(increment_key(*from_hex("0x0f0f")) == std::nullopt);
+    CHECK(increment_key(*from_hex("0x0a0b")) == *from_hex("0x0a0c"));
+}
+
+}  // namespace silkworm::trie
@@ -58,4 +58,30 @@ TEST_CASE("Nibbles") {
     REQUIRE(to_hex(pack_nibbles(odd_input)) == "1230");
 }
 
+TEST_CASE("Packed nibbles") {
+    // The low nibble of an odd string is ignored
+    const Bytes data{*from_hex("0a1b2c3f")};
+    const PackedNibbles odd{data, /*odd_length=*/true};
+    CHECK(odd.length() == 7);
+    CHECK(odd[0] == 0x0);
+    CHECK(odd[5] == 0xc);
+    CHECK(odd[6] == 0x3);
+    CHECK(odd == PackedNibbles{*from_hex("0a1b2c30"), true});
+    CHECK(odd.prefix(3) == PackedNibbles{*from_hex("0a10"), true});
+
+    const std::vector<std::string> sorted{"", "0a", "0a00", "0a0b", "0a0b00", "0a0b0c0d", "0b", "0f0f0f"};
+    for (size_t i{0}; i < sorted.size(); ++i) {
+        const Bytes a{*from_hex(sorted[i])};
+        const Bytes packed_a{pack_nibbles(a)};
+        for (size_t j{0}; j < sorted.size(); ++j) {
+            const Bytes b{*from_hex(sorted[j])};
+            const Bytes packed_b{pack_nibbles(b)};
+            const PackedNibbles x{packed_a, (a.length() & 1) != 0};
+            const PackedNibbles y{packed_b, (b.length() & 1) != 0};
+            CHECK((x <=> y) == (i <=> j));
+            CHECK(prefix_length(x, y) == prefix_length(a, b));
+        }
+    }
+}
+
 }  // namespace silkworm::trie
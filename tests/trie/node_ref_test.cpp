@@ -0,0 +1,50 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <bit>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/util.hpp>
+#include <merkle-patricia-tree/trie/node_ref.hpp>
+#include <merkle-patricia-tree/types/evmc_bytes32.hpp>
+
+namespace silkworm::trie {
+
+TEST_CASE("NodeRef") {
+    CHECK(NodeRef{}.empty());
+    CHECK(ByteView{NodeRef{}}.empty());
+
+    // A leaf of path 0x31 and value 0x61, embedded as is
+    const Bytes short_rlp{*from_hex("c22031")};
+    const NodeRef embedded{NodeRef::from_rlp(short_rlp)};
+    CHECK(!embedded.is_hash());
+    CHECK(ByteView{embedded} == short_rlp);
+    CHECK(embedded.node_hash() == std::bit_cast<evmc::bytes32>(keccak256(short_rlp)));
+
+    const Bytes long_rlp(kHashLength, 0xc0);
+    const NodeRef hashed{NodeRef::from_rlp(long_rlp)};
+    const auto hash{std::bit_cast<evmc::bytes32>(keccak256(long_rlp))};
+    CHECK(hashed.is_hash());
+    CHECK(hashed.length() == kHashLength + 1);
+    CHECK(hashed.data()[0] == 0xa0);
+    CHECK(hashed.hash() == hash);
+    CHECK(hashed.node_hash() == hash);
+    CHECK(hashed == NodeRef::from_hash(hash.bytes));
+    CHECK(hashed != embedded);
+}
+
+}  // namespace silkworm::trie
@@ -16,8 +16,10 @@
 
 #include <merkle-patricia-tree/trie/node.hpp>
 
+#include <algorithm>
 #include <bit>
 #include <utility>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -73,4 +75,111 @@ TEST_CASE("Node marshalling") {
     CHECK(!Node::decode_from_storage(raw, x));
 }
 
+TEST_CASE("Node reused for decoding") {
+    const auto hash{0x90d53cd810cc5d4243766cd4451e7b9d14b736a1148b26b3baac7617f617d321_bytes32};
+    const Node one_hash{/*state_mask*/ 0x0003, /*tree_mask*/ 0x0000, /*hash_mask*/ 0x0001, {hash}};
+
+    // Decoding a node with fewer hashes leaves stale slots behind, which are ignored
+    Node node{/*state_mask*/ 0x0003, /*tree_mask*/ 0x0000, /*hash_mask*/ 0x0003, {hash, hash}};
+    REQUIRE(Node::decode_from_storage(one_hash.encode_for_storage(), node));
+    CHECK(node.hashes().size() == 1);
+    CHECK(node == one_hash);
+
+    // Copies are plain copies of the inline hashes
+    const Node copy{node};
+    CHECK(copy == one_hash);
+    CHECK(copy.hashes().data() != node.hashes().data());
+}
+
+TEST_CASE("NodeView") {
+    const auto hash1{0x90d53cd810cc5d4243766cd4451e7b9d14b736a1148b26b3baac7617f617d321_bytes32};
+    const auto hash2{0xcc35c964dda53ba6c0b87798073a9628dbc9cd26b5cce88eb69655a9c609caf1_bytes32};
+    const auto root{0xaaaabbbb0006767767776fffffeee44444000005567645600000000eeddddddd_bytes32};
+
+    for (const auto& root_hash : {std::optional<evmc::bytes32>{}, std::optional{root}}) {
+        const Node n{/*state_mask*/ 0xf607, /*tree_mask*/ 0x0005, /*hash_mask*/ 0x4004, {hash1, hash2}, root_hash};
+        const Bytes raw{n.encode_for_storage()};
+
+        NodeView view;
+        REQUIRE(NodeView::from_storage(raw, view));
+        CHECK(view.state_mask() == 0xf607);
+        CHECK(view.tree_mask() == 0x0005);
+        CHECK(view.hash_mask() == 0x4004);
+        if (root_hash) {
+            REQUIRE(view.root_hash());
+            CHECK(*view.root_hash() == root);
+        } else {
+            CHECK(!view.root_hash());
+        }
+
+        // Hashes are read in place
+        REQUIRE(view.hashes().size() == 2);
+        CHECK(reinterpret_cast<const uint8_t*>(view.hashes().data()) == &raw[raw.length() - 2 * kHashLength]);
+        CHECK(view.child_hash(0x1) == nullptr);
+        CHECK(*view.child_hash(0x2) == hash1);
+        CHECK(*view.child_hash(0xe) == hash2);
+
+        CHECK(view.to_node() == n);
+    }
+
+    // Same validation as Node::decode_from_storage
+    NodeView view;
+    for (const auto hex : {"", "0xf607", "0xf60700054004", "0x000000054004"}) {
+        const Bytes raw{*from_hex(hex)};
+        CHECK(!NodeView::from_storage(raw, view));
+    }
+}
+
+TEST_CASE("EncodedNodes") {
+    const auto hash1{0x90d53cd810cc5d4243766cd4451e7b9d14b736a1148b26b3baac7617f617d321_bytes32};
+    const auto hash2{0xcc35c964dda53ba6c0b87798073a9628dbc9cd26b5cce88eb69655a9c609caf1_bytes32};
+    const std::vector<Node> nodes{
+        Node{/*state_mask*/ 0xf607, /*tree_mask*/ 0x0005, /*hash_mask*/ 0x4004, {hash1, hash2}, hash2},
+        Node{/*state_mask*/ 0x0003, /*tree_mask*/ 0x0001, /*hash_mask*/ 0x0000, {}},
+        Node{/*state_mask*/ 0x0110, /*tree_mask*/ 0x0000, /*hash_mask*/ 0x0100, {hash1}},
+    };
+
+    EncodedNodes one_by_one;
+    for (const Node& node : nodes) {
+        one_by_one.append(node);
+    }
+    EncodedNodes batch;
+    batch.append(nodes);
+    CHECK(batch.buffer() == one_by_one.buffer());
+    CHECK(std::ranges::equal(batch.offsets(), one_by_one.offsets()));
+
+    REQUIRE(batch.size() == nodes.size());
+    for (size_t i{0}; i < nodes.size(); ++i) {
+        CHECK(batch[i] == nodes[i].encode_for_storage());
+    }
+
+    std::vector<Node> decoded;
+    REQUIRE(batch.decode(decoded));
+    CHECK(decoded == nodes);
+
+    // Nodes read back from storage, e.g. along with their index
+    const Bytes stored{batch.buffer()};
+    const std::vector<size_t> offsets(batch.offsets().begin(), batch.offsets().end());
+    decoded.clear();
+    REQUIRE(EncodedNodes::decode(stored, offsets, decoded));
+    CHECK(decoded == nodes);
+
+    // A single invalid node fails the whole batch, leaving the output as is
+    Bytes corrupted{stored};
+    corrupted[offsets[2]] = 0x00;  // the hash mask is no longer a subset of the state mask
+    decoded.clear();
+    CHECK(EncodedNodes::decode(corrupted, offsets, decoded).error() == DecodingError::kInvalidMasksSubsets);
+    CHECK(decoded.empty());
+    CHECK(EncodedNodes::decode(stored.substr(0, stored.length() - 1), offsets, decoded).error() ==
+          DecodingError::kInputTooShort);
+    CHECK(!EncodedNodes::decode(stored, {}, decoded));
+    CHECK(decoded.empty());
+
+    batch.clear();
+    CHECK(batch.empty());
+    CHECK(batch.buffer().empty());
+    REQUIRE(batch.decode(decoded));
+    CHECK(decoded.empty());
+}
+
 }  // namespace silkworm::trie
@@ -0,0 +1,141 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/empty_hashes.hpp>
+#include <merkle-patricia-tree/common/endian.hpp>
+#include <merkle-patricia-tree/common/util.hpp>
+#include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/nibbles.hpp>
+#include <merkle-patricia-tree/trie/parallel_hash_builder.hpp>
+#include <merkle-patricia-tree/types/evmc_bytes32.hpp>
+
+namespace silkworm::trie {
+
+using Collected = std::vector<std::pair<Bytes, Bytes>>;
+
+// Hashed keys, as in the state trie
+static std::map<Bytes, Bytes> hashed_leaves(size_t count) {
+    std::map<Bytes, Bytes> leaves;
+    for (size_t i{0}; i < count; ++i) {
+        uint8_t index[8];
+        endian::store_big_u64(index, i);
+        const ethash::hash256 key{keccak256(index)};
+        leaves.emplace(unpack_nibbles(key.bytes), Bytes(1 + i % 40, static_cast<uint8_t>(i)));
+    }
+    return leaves;
+}
+
+template <class Builder>
+static std::pair<evmc::bytes32, Collected> build(Builder& builder, const std::map<Bytes, Bytes>& leaves) {
+    Collected collected;
+    builder.node_collector = [&collected](ByteView nibbled_key, const Node& node) {
+        collected.emplace_back(Bytes{nibbled_key}, node.encode_for_storage());
+    };
+    for (const auto& [key, value] : leaves) {
+        builder.add_leaf(key, value);
+    }
+    return {builder.root_hash(), collected};
+}
+
+TEST_CASE("ParallelHashBuilder empty trie") {
+    ParallelHashBuilder phb{2};
+    CHECK(phb.root_hash() == kEmptyRoot);
+}
+
+TEST_CASE("ParallelHashBuilder matches HashBuilder") {
+    for (const size_t split_nibbles : {1u, 2u}) {
+        for (const size_t count : {1u, 2u, 17u, 300u, 5'000u}) {
+            const auto leaves{hashed_leaves(count)};
+
+            HashBuilder hb;
+            const auto expected{build(hb, leaves)};
+
+            ParallelHashBuilder phb{4, split_nibbles};
+            const auto actual{build(phb, leaves)};
+
+            CHECK(to_hex(actual.first) == to_hex(expected.first));
+            CHECK(actual.second == expected.second);
+
+            // Reusable after reset
+            phb.reset();
+            CHECK(build(phb, leaves).first == expected.first);
+        }
+    }
+}
+
+TEST_CASE("ParallelHashBuilder with bounded buckets") {
+    const auto leaves{hashed_leaves(5'000)};
+    HashBuilder hb;
+    const auto expected{build(hb, leaves)};
+
+    // Buckets cut within the leaves of a leading nibble, many more than the threads can take at once
+    for (const size_t bucket_size : {1u, 7u, 100u}) {
+        ParallelHashBuilder phb{2, /*split_nibbles=*/1, bucket_size};
+        const auto actual{build(phb, leaves)};
+        CHECK(to_hex(actual.first) == to_hex(expected.first));
+        CHECK(actual.second == expected.second);
+    }
+}
+
+TEST_CASE("ParallelHashBuilder with embedded nodes") {
+    // Short keys & values make subtries whose branch nodes are shorter than 32 bytes
+    std::map<Bytes, Bytes> leaves;
+    for (uint8_t i{0}; i < 0x40; i += 3) {
+        leaves.emplace(Bytes{static_cast<uint8_t>(i >> 4), static_cast<uint8_t>(i & 0x0f)}, Bytes{i});
+    }
+    leaves.emplace(*from_hex("0e0000"), *from_hex("01"));
+    leaves.emplace(*from_hex("0e0001"), *from_hex("02"));
+
+    HashBuilder hb;
+    for (const auto& [key, value] : leaves) {
+        hb.add_leaf(key, value);
+    }
+    const evmc::bytes32 expected{hb.root_hash()};
+
+    for (const size_t split_nibbles : {1u, 2u}) {
+        ParallelHashBuilder phb{3, split_nibbles};
+        for (const auto& [key, value] : leaves) {
+            phb.add_leaf(key, value);
+        }
+        CHECK(to_hex(phb.root_hash()) == to_hex(expected));
+    }
+}
+
+TEST_CASE("ParallelHashBuilder single subtrie") {
+    // All the leaves share the first nibble, so there's no branch node at the root
+    std::map<Bytes, Bytes> leaves;
+    for (const auto& [key, value] : hashed_leaves(200)) {
+        Bytes k{key};
+        k[0] = 0x0a;
+        leaves.emplace(std::move(k), value);
+    }
+
+    HashBuilder hb;
+    const auto expected{build(hb, leaves)};
+
+    ParallelHashBuilder phb{2};
+    const auto actual{build(phb, leaves)};
+    CHECK(to_hex(actual.first) == to_hex(expected.first));
+    CHECK(actual.second == expected.second);
+}
+
+}  // namespace silkworm::trie
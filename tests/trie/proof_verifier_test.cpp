@@ -0,0 +1,180 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/empty_hashes.hpp>
+#include <merkle-patricia-tree/common/util.hpp>
+#include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/nibbles.hpp>
+#include <merkle-patricia-tree/trie/proof_verifier.hpp>
+
+namespace silkworm::trie {
+
+// Builds the trie of the entries, retaining the proofs of targets
+static evmc::bytes32 build(const std::map<Bytes, Bytes>& entries, const std::vector<Bytes>& targets,
+                           ProofRetainer& retainer) {
+    PrefixSet prefix_set;
+    for (const auto& key : targets) {
+        prefix_set.insert(unpack_nibbles(key));
+    }
+    HashBuilder hb;
+    hb.proof_retainer.emplace(prefix_set);
+    for (const auto& [key, value] : entries) {
+        hb.add_leaf(PackedNibbles{key}, value);
+    }
+    const evmc::bytes32 root{hb.root_hash()};
+    retainer = std::move(*hb.proof_retainer);
+    return root;
+}
+
+TEST_CASE("Batch proof verification") {
+    std::map<Bytes, Bytes> entries;
+    for (uint16_t i{0}; i < 1'000; ++i) {
+        entries.emplace(Bytes{keccak256(Bytes{static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8)}).bytes, kHashLength},
+                        Bytes(1 + i % 40, static_cast<uint8_t>(i)));
+    }
+
+    std::vector<Bytes> present;
+    for (auto it{entries.begin()}; it != entries.end(); std::advance(it, 37)) {
+        present.push_back(it->first);
+        if (std::distance(it, entries.end()) <= 37) {
+            break;
+        }
+    }
+    std::vector<Bytes> absent{Bytes(kHashLength, 0x00), Bytes(kHashLength, 0xff), present[3]};
+    absent.back().back() ^= 0x01;
+    std::vector<Bytes> targets{present};
+    targets.insert(targets.end(), absent.begin(), absent.end());
+
+    ProofRetainer retainer{PrefixSet{}};
+    const evmc::bytes32 root{build(entries, targets, retainer)};
+
+    std::vector<std::vector<Bytes>> proofs;
+    std::vector<ProofClaim> claims;
+    for (const auto& key : targets) {
+        proofs.push_back(retainer.proof(unpack_nibbles(key)));
+    }
+    for (size_t i{0}; i < targets.size(); ++i) {
+        const auto it{entries.find(targets[i])};
+        claims.push_back({targets[i], it != entries.end() ? ByteView{it->second} : ByteView{}, proofs[i]});
+    }
+
+    SECTION("Separate proofs") {
+        const std::vector<bool> results{verify_proofs(root, claims)};
+        CHECK(std::all_of(results.begin(), results.end(), [](bool ok) { return ok; }));
+
+        // Shared upper nodes are pooled
+        ProofVerifier verifier{root};
+        size_t total_nodes{0};
+        for (const auto& proof : proofs) {
+            verifier.add_nodes(proof);
+            total_nodes += proof.size();
+        }
+        CHECK(verifier.num_nodes() == retainer.nodes().size());
+        CHECK(verifier.num_nodes() < total_nodes);
+    }
+
+    SECTION("Multiproof") {
+        std::vector<ByteView> multiproof;
+        for (const auto& [_, rlp] : retainer.nodes()) {
+            multiproof.emplace_back(rlp);
+        }
+        ProofVerifier verifier{root};
+        verifier.add_nodes(multiproof);
+        for (const auto& claim : claims) {
+            CHECK(verifier.verify(claim.key, claim.value));
+        }
+    }
+
+    SECTION("Wrong claims") {
+        ProofVerifier verifier{root};
+        for (const auto& proof : proofs) {
+            verifier.add_nodes(proof);
+        }
+        for (const auto& key : present) {
+            CHECK(!verifier.verify(key, {}));
+            CHECK(!verifier.verify(key, *from_hex("0xbadbad")));
+        }
+        for (const auto& key : absent) {
+            CHECK(!verifier.verify(key, *from_hex("0x01")));
+        }
+        // Not covered by the proofs
+        Bytes other{present[0]};
+        other[0] ^= 0x80;
+        CHECK(!verifier.verify(other, {}));
+
+        ProofVerifier wrong_root{kEmptyRoot};
+        wrong_root.add_nodes(proofs[0]);
+        CHECK(!wrong_root.verify(present[0], entries[present[0]]));
+    }
+
+    SECTION("Tampered proofs") {
+        std::vector<Bytes> tampered{proofs[0]};
+        tampered.back().back() ^= 0x01;
+        ProofVerifier verifier{root};
+        verifier.add_nodes(tampered);
+        CHECK(!verifier.verify(present[0], entries[present[0]]));
+
+        std::vector<Bytes> truncated{proofs[0]};
+        truncated.back().pop_back();
+        const std::vector<ProofClaim> truncated_claims{{present[0], entries[present[0]], truncated}};
+        CHECK(!verify_proofs(root, truncated_claims)[0]);
+    }
+}
+
+// Short keys and values make for nodes embedded into their parents
+TEST_CASE("Proofs with embedded nodes") {
+    std::map<Bytes, Bytes> entries;
+    for (uint8_t i{0}; i < 40; ++i) {
+        entries.emplace(Bytes{static_cast<uint8_t>(i * 5), 0x01}, Bytes{i});
+    }
+    std::vector<Bytes> targets{Bytes{0x00, 0x01}, Bytes{0x37, 0x01}, Bytes{0x37, 0x02}, Bytes{0x38, 0x01}};
+
+    ProofRetainer retainer{PrefixSet{}};
+    const evmc::bytes32 root{build(entries, targets, retainer)};
+    std::vector<std::vector<Bytes>> proofs;
+    ProofVerifier verifier{root};
+    for (const auto& key : targets) {
+        verifier.add_nodes(proofs.emplace_back(retainer.proof(unpack_nibbles(key))));
+    }
+    CHECK(verifier.verify(targets[0], Bytes{0}));
+    CHECK(verifier.verify(targets[1], Bytes{11}));
+    CHECK(verifier.verify(targets[2], {}));
+    CHECK(verifier.verify(targets[3], {}));
+    CHECK(!verifier.verify(targets[1], Bytes{12}));
+}
+
+TEST_CASE("ProofNode decoding") {
+    ProofNode node;
+    // leaf with an odd path [1] and value "a"
+    const Bytes leaf{*from_hex("0xc23161")};
+    CHECK(ProofNode::decode(leaf, node));
+    CHECK(node.kind == ProofNode::Kind::kLeaf);
+    CHECK(node.path == *from_hex("0x31"));
+    CHECK(node.items[0] == *from_hex("0x61"));
+
+    CHECK(ProofNode::decode(*from_hex("0xc3316161"), node).error() == DecodingError::kUnexpectedListElements);
+    CHECK(ProofNode::decode(*from_hex("0xc431"), node).error() == DecodingError::kInputTooShort);
+    CHECK(ProofNode::decode(*from_hex("0x83316161"), node).error() == DecodingError::kUnexpectedString);
+}
+
+}  // namespace silkworm::trie
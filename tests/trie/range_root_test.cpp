@@ -0,0 +1,102 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/empty_hashes.hpp>
+#include <merkle-patricia-tree/common/thread_pool.hpp>
+#include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/range_root.hpp>
+#include <merkle-patricia-tree/types/evmc_bytes32.hpp>
+
+#include "test_util.hpp"
+
+namespace silkworm::trie {
+
+namespace {
+
+    // Leaves crowding under a few long prefixes, so that boundaries fall deep in the trie
+    std::vector<std::pair<Bytes, Bytes>> skewed_leaves() {
+        std::mt19937_64 rng{42};
+        const auto leaves{test::random_leaves_with(3'000, rng, [](std::mt19937_64& r) {
+            Bytes key(64, 0);
+            const size_t crowded{r() % 4 == 0 ? 0 : 1 + r() % 20};  // leading nibbles shared
+            for (size_t i{0}; i < key.length(); ++i) {
+                key[i] = i < crowded ? static_cast<uint8_t>(i % 3) : static_cast<uint8_t>(r() % 16);
+            }
+            return key;
+        })};
+        return {leaves.begin(), leaves.end()};
+    }
+
+}  // namespace
+
+TEST_CASE("Range root") {
+    const std::vector<std::pair<Bytes, Bytes>> leaves{skewed_leaves()};
+    const std::span<const std::pair<Bytes, Bytes>> all{leaves};
+
+    const auto [root, expected_nodes]{test::reference_trie(leaves, /*packed=*/false)};
+
+    SECTION("Ranges cut anywhere") {
+        std::mt19937_64 rng{7};
+        for (size_t round{0}; round < 20; ++round) {
+            std::vector<size_t> cuts{0, leaves.size()};
+            for (size_t i{0}; i < round; ++i) {
+                cuts.push_back(rng() % leaves.size());
+            }
+            std::sort(cuts.begin(), cuts.end());
+
+            std::vector<std::pair<Bytes, Node>> nodes;
+            HashBuilder hb;
+            hb.node_collector = [&](ByteView nibbled_key, const Node& node) { nodes.emplace_back(nibbled_key, node); };
+            size_t num_subtries{0};
+            for (size_t i{0}; i + 1 < cuts.size(); ++i) {
+                TrieRange range{build_range(all.subspan(cuts[i], cuts[i + 1] - cuts[i]), /*collect_nodes=*/true)};
+                num_subtries += range.subtries.size();
+                fold_range(hb, range);
+            }
+            CHECK(hb.root_hash() == root);
+            CHECK(nodes == expected_nodes);
+            CHECK(num_subtries < leaves.size());
+        }
+    }
+
+    SECTION("Single leaves") {
+        HashBuilder hb;
+        for (size_t i{0}; i < leaves.size(); ++i) {
+            TrieRange range{build_range(all.subspan(i, 1), /*collect_nodes=*/false)};
+            REQUIRE(range.subtries.size() == 1);
+            fold_range(hb, range);
+        }
+        CHECK(hb.root_hash() == root);
+    }
+
+    SECTION("Equal-sized ranges in parallel") {
+        ThreadPool pool{4};
+        for (size_t num_ranges : {1, 2, 7, 64, 5'000}) {
+            CHECK(range_root_hash(all, num_ranges, &pool) == root);
+        }
+        CHECK(range_root_hash(all, 16) == root);
+        CHECK(range_root_hash({}, 4, &pool) == kEmptyRoot);
+    }
+}
+
+}  // namespace silkworm::trie
@@ -0,0 +1,76 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/empty_hashes.hpp>
+#include <merkle-patricia-tree/common/endian.hpp>
+#include <merkle-patricia-tree/common/thread_pool.hpp>
+#include <merkle-patricia-tree/common/util.hpp>
+#include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/nibbles.hpp>
+#include <merkle-patricia-tree/trie/secure_root.hpp>
+#include <merkle-patricia-tree/types/evmc_bytes32.hpp>
+
+namespace silkworm::trie {
+
+TEST_CASE("Secure root of no entries") {
+    CHECK(secure_root_hash({}) == kEmptyRoot);
+}
+
+TEST_CASE("Secure root") {
+    ThreadPool pool{4};
+    // Below and above the size hashed by a single task
+    for (const size_t count : {1u, 2u, 100u, 10'000u}) {
+        std::vector<Bytes> keys;
+        std::vector<Bytes> values;
+        for (size_t i{0}; i < count; ++i) {
+            // 20-byte keys, as addresses
+            Bytes key(20, 0);
+            endian::store_big_u64(&key[12], i * 7919);
+            keys.push_back(std::move(key));
+            values.emplace_back(1 + i % 70, static_cast<uint8_t>(i));
+        }
+
+        std::map<Bytes, Bytes> hashed;
+        for (size_t i{0}; i < count; ++i) {
+            hashed.emplace(Bytes{keccak256(keys[i]).bytes, kHashLength}, values[i]);
+        }
+        HashBuilder hb;
+        for (const auto& [key, value] : hashed) {
+            hb.add_leaf(unpack_nibbles(key), value);
+        }
+        const evmc::bytes32 expected_root{hb.root_hash()};
+
+        std::vector<std::pair<ByteView, ByteView>> entries;
+        for (size_t i{0}; i < count; ++i) {
+            entries.emplace_back(keys[i], values[i]);
+        }
+        CHECK(secure_root_hash(entries) == expected_root);
+        CHECK(secure_root_hash(entries, &pool) == expected_root);
+
+        // The order of the entries doesn't matter
+        std::reverse(entries.begin(), entries.end());
+        CHECK(secure_root_hash(entries, &pool) == expected_root);
+    }
+}
+
+}  // namespace silkworm::trie
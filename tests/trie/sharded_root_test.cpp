@@ -0,0 +1,126 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <filesystem>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/empty_hashes.hpp>
+#include <merkle-patricia-tree/trie/sharded_root.hpp>
+#include <merkle-patricia-tree/types/evmc_bytes32.hpp>
+
+#include "test_util.hpp"
+
+namespace silkworm::trie {
+
+TEST_CASE("ShardedRootCoordinator") {
+    test::TemporaryDirectory dir{"mpt-sharded-root-test"};
+    const std::filesystem::path leaves_file{dir.path / "leaves"};
+    const std::filesystem::path work_dir{dir.path / "work"};
+    std::filesystem::create_directories(work_dir);
+
+    std::mt19937_64 rng{42};
+    const std::map<Bytes, Bytes> sorted{test::random_leaves(5'000, rng)};
+    const std::vector<std::pair<ByteView, ByteView>> leaves(sorted.begin(), sorted.end());
+    const auto [root, expected_nodes]{test::reference_trie(sorted)};
+
+    SECTION("Shards of 1 and 2 nibbles") {
+        write_leaves_file(leaves_file, leaves);
+        for (size_t split_nibbles : {1, 2}) {
+            ShardedRootCoordinator coordinator{/*num_processes=*/3, split_nibbles, work_dir};
+            CHECK(coordinator.root_hash(leaves_file) == root);
+        }
+        CHECK(std::filesystem::is_empty(work_dir));
+    }
+
+    SECTION("Nodes collected by the workers") {
+        write_leaves_file(leaves_file, leaves);
+        std::vector<std::pair<Bytes, Node>> nodes;
+        ShardedRootCoordinator coordinator{/*num_processes=*/2, /*split_nibbles=*/1, work_dir};
+        coordinator.node_collector = [&](ByteView nibbled_key, const Node& node) { nodes.emplace_back(nibbled_key, node); };
+        CHECK(coordinator.root_hash(leaves_file) == root);
+        CHECK(nodes == expected_nodes);
+    }
+
+    SECTION("Few leaves") {
+        ShardedRootCoordinator coordinator{/*num_processes=*/2, /*split_nibbles=*/1, work_dir};
+        write_leaves_file(leaves_file, {});
+        CHECK(coordinator.root_hash(leaves_file) == kEmptyRoot);
+
+        // An embedded branch node in shard 1 and a single leaf in shard 2
+        const Bytes keys{0x10, 0x11, 0x20};
+        const Bytes value{0x01};
+        std::vector<std::pair<ByteView, ByteView>> few;
+        for (size_t i{0}; i < keys.length(); ++i) {
+            few.emplace_back(ByteView{&keys[i], 1}, value);
+        }
+        write_leaves_file(leaves_file, few);
+        CHECK(coordinator.root_hash(leaves_file) == test::reference_root(few));
+    }
+
+    SECTION("Invalid files") {
+        ShardedRootCoordinator coordinator{/*num_processes=*/2, /*split_nibbles=*/1, work_dir};
+        CHECK_THROWS_AS(coordinator.root_hash(dir.path / "missing"), std::runtime_error);
+
+        std::vector<std::pair<ByteView, ByteView>> unsorted(leaves);
+        std::swap(unsorted[10], unsorted[20]);
+        write_leaves_file(leaves_file, unsorted);
+        CHECK_THROWS_AS(coordinator.root_hash(leaves_file), std::runtime_error);
+
+        // Cut within the header of the last leaf, whose lengths are then only partly read
+        write_leaves_file(leaves_file, leaves);
+        const size_t last_leaf_length{leaves.back().first.length() + leaves.back().second.length()};
+        std::filesystem::resize_file(leaves_file, std::filesystem::file_size(leaves_file) - last_leaf_length - 4);
+        CHECK_THROWS_AS(coordinator.root_hash(leaves_file), std::runtime_error);
+
+        // Errors don't escape the C API
+        auto c_coordinator{silkworm_ShardedRootCoordinator_new(2, 1, work_dir.string().c_str())};
+        uint8_t out_hash[32];
+        CHECK(silkworm_ShardedRootCoordinator_root_hash(c_coordinator, leaves_file.string().c_str(), out_hash) == 0);
+        silkworm_ShardedRootCoordinator_free(c_coordinator);
+    }
+
+    SECTION("Failing workers") {
+        const auto no_result_files{[&] {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator{dir.path}) {
+                if (entry.path().filename().string().starts_with("mpt-shard-")) {
+                    return false;
+                }
+            }
+            return true;
+        }};
+
+        // Truncated within the value of the last leaf, which only the worker of the last shard reads
+        write_leaves_file(leaves_file, leaves);
+        std::filesystem::resize_file(leaves_file, std::filesystem::file_size(leaves_file) - 1);
+        ShardedRootCoordinator coordinator{/*num_processes=*/3, /*split_nibbles=*/1, work_dir};
+        CHECK_THROWS_WITH(coordinator.root_hash(leaves_file), "ShardedRootCoordinator: a worker failed");
+        CHECK(no_result_files());
+
+        // No result file can be created
+        write_leaves_file(leaves_file, leaves);
+        ShardedRootCoordinator nowhere{/*num_processes=*/3, /*split_nibbles=*/1, work_dir / "missing"};
+        CHECK_THROWS_WITH(nowhere.root_hash(leaves_file), "ShardedRootCoordinator: a worker failed");
+        CHECK(no_result_files());
+    }
+}
+
+}  // namespace silkworm::trie
@@ -0,0 +1,111 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef SILKWORM_TRIE_TEST_UTIL_HPP
+#define SILKWORM_TRIE_TEST_UTIL_HPP
+
+#include <filesystem>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <merkle-patricia-tree/common/base.hpp>
+#include <merkle-patricia-tree/trie/hash_builder.hpp>
+#include <merkle-patricia-tree/trie/nibbles.hpp>
+#include <merkle-patricia-tree/trie/node.hpp>
+
+// Helpers shared by the tests of the trie builders, checked against HashBuilder
+namespace silkworm::trie::test {
+
+    //! \brief Value of 1 byte to a hash and beyond, so that nodes are both embedded and hashed
+    inline Bytes random_value(std::mt19937_64 &rng) {
+        const size_t length{1 + rng() % 40};
+        return Bytes(length, static_cast<uint8_t>(rng()));
+    }
+
+    //! \brief Leaves of count distinct keys, each drawn by make_key(rng), sorted by key
+    template<class MakeKey>
+    std::map<Bytes, Bytes> random_leaves_with(size_t count, std::mt19937_64 &rng, MakeKey make_key) {
+        std::map<Bytes, Bytes> leaves;
+        while (leaves.size() < count) {
+            Bytes key{make_key(rng)};
+            leaves.emplace(std::move(key), random_value(rng));
+        }
+        return leaves;
+    }
+
+    //! \brief Leaves of count distinct keys of random bytes, sorted by key
+    inline std::map<Bytes, Bytes> random_leaves(size_t count, std::mt19937_64 &rng, size_t key_length = kHashLength) {
+        return random_leaves_with(count, rng, [key_length](std::mt19937_64 &r) {
+            Bytes key(key_length, 0);
+            for (auto &b : key) {
+                b = static_cast<uint8_t>(r());
+            }
+            return key;
+        });
+    }
+
+    //! \brief Root of some leaves as computed by HashBuilder
+    //! \param [in] leaves : pairs of a key and a value, sorted by key
+    //! \param [in] packed : whether keys are packed nibbles, or else of one nibble per byte
+    template<class Leaves>
+    evmc::bytes32 reference_root(const Leaves &leaves, bool packed = true, NodeCollector node_collector = nullptr) {
+        HashBuilder hb;
+        hb.node_collector = std::move(node_collector);
+        for (const auto &[key, value] : leaves) {
+            if (packed) {
+                hb.add_leaf(PackedNibbles{key}, value);
+            } else {
+                hb.add_leaf(Bytes{key}, value);
+            }
+        }
+        return hb.root_hash();
+    }
+
+    //! \brief Root and nodes of some leaves as computed by HashBuilder
+    struct ReferenceTrie {
+        evmc::bytes32 root;
+        std::vector<std::pair<Bytes, Node>> nodes;
+    };
+
+    //! \remarks As in HashBuilder, nodes can only be collected if no branch node is embedded, e.g. for hashed keys
+    template<class Leaves>
+    ReferenceTrie reference_trie(const Leaves &leaves, bool packed = true) {
+        ReferenceTrie trie;
+        trie.root = reference_root(leaves, packed, [&](ByteView nibbled_key, const Node &node) {
+            trie.nodes.emplace_back(nibbled_key, node);
+        });
+        return trie;
+    }
+
+    //! \brief A fresh directory, removed along with its content
+    struct TemporaryDirectory {
+        explicit TemporaryDirectory(const std::string &name) : path{std::filesystem::temp_directory_path() / name} {
+            std::filesystem::remove_all(path);
+            std::filesystem::create_directories(path);
+        }
+        ~TemporaryDirectory() { std::filesystem::remove_all(path); }
+
+        [[nodiscard]] bool empty() const { return std::filesystem::is_empty(path); }
+
+        std::filesystem::path path;
+    };
+
+}  // namespace silkworm::trie::test
+
+#endif // SILKWORM_TRIE_TEST_UTIL_HPP
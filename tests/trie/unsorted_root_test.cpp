@@ -0,0 +1,124 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <merkle-patricia-tree/common/empty_hashes.hpp>
+#include <merkle-patricia-tree/common/thread_pool.hpp>
+#include <merkle-patricia-tree/trie/unsorted_root.hpp>
+#include <merkle-patricia-tree/types/evmc_bytes32.hpp>
+
+#include "test_util.hpp"
+
+namespace silkworm::trie {
+
+TEST_CASE("Radix sort") {
+    std::mt19937_64 rng{42};
+    ThreadPool pool{4};
+
+    // Above the partition chunk, so that the leading pass is split among tasks too
+    for (const size_t count : {0u, 1u, 50u, 1'000u, 200'000u}) {
+        std::vector<Bytes> keys;
+        for (size_t i{0}; i < count; ++i) {
+            // Few distinct bytes and lengths, so that keys share long prefixes, are prefixes of others or repeat
+            Bytes key(rng() % 5, 0);
+            for (auto& b : key) {
+                b = static_cast<uint8_t>(rng() % 3 * 0x21);
+            }
+            keys.push_back(std::move(key));
+        }
+        std::vector<ByteView> expected(keys.begin(), keys.end());
+        std::sort(expected.begin(), expected.end());
+
+        for (ThreadPool* p : {static_cast<ThreadPool*>(nullptr), &pool}) {
+            std::vector<std::pair<ByteView, ByteView>> entries;
+            for (const Bytes& key : keys) {
+                entries.emplace_back(key, key);
+            }
+            const RadixBuckets buckets{radix_sort(entries, p)};
+
+            REQUIRE(entries.size() == expected.size());
+            for (size_t i{0}; i < entries.size(); ++i) {
+                REQUIRE(entries[i].first == expected[i]);
+                // Values move along with their keys
+                REQUIRE(entries[i].second.data() == entries[i].first.data());
+            }
+
+            const auto first_nonempty{std::upper_bound(expected.begin(), expected.end(), ByteView{})};
+            CHECK(buckets[0] == static_cast<size_t>(first_nonempty - expected.begin()));
+            CHECK(buckets[16] == count);
+            for (size_t b{0}; b < 16; ++b) {
+                for (size_t i{buckets[b]}; i < buckets[b + 1]; ++i) {
+                    REQUIRE(entries[i].first[0] >> 4 == b);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Unsorted root of no entries") {
+    CHECK(unsorted_root_hash({}) == kEmptyRoot);
+}
+
+TEST_CASE("Unsorted root") {
+    std::mt19937_64 rng{42};
+    ThreadPool pool{4};
+
+    // Below and above the size built in parallel
+    for (const size_t count : {1u, 2u, 100u, 20'000u}) {
+        for (const size_t key_length : {4u, 32u}) {
+            const std::map<Bytes, Bytes> sorted{test::random_leaves(count, rng, key_length)};
+            const evmc::bytes32 expected_root{test::reference_root(sorted)};
+
+            std::vector<std::pair<ByteView, ByteView>> entries(sorted.begin(), sorted.end());
+            std::shuffle(entries.begin(), entries.end(), rng);
+            CHECK(unsorted_root_hash(entries) == expected_root);
+            CHECK(unsorted_root_hash(entries, &pool) == expected_root);
+        }
+    }
+}
+
+TEST_CASE("Unsorted root of invalid keys") {
+    std::mt19937_64 rng{42};
+    ThreadPool pool{4};
+
+    // Below and above the size built in parallel
+    for (const size_t count : {10u, 20'000u}) {
+        const std::map<Bytes, Bytes> sorted{test::random_leaves(count, rng)};
+        const std::vector<std::pair<ByteView, ByteView>> valid(sorted.begin(), sorted.end());
+        const Bytes value{0x01};
+
+        std::vector<std::vector<std::pair<ByteView, ByteView>>> invalid(3, valid);
+        invalid[0].emplace_back(ByteView{}, value);
+        invalid[1].push_back(valid[count / 2]);
+        invalid[2].emplace_back(valid[count / 3].first.substr(0, 5), value);
+
+        for (auto& entries : invalid) {
+            std::shuffle(entries.begin(), entries.end(), rng);
+            CHECK_THROWS_AS(unsorted_root_hash(entries), std::invalid_argument);
+            CHECK_THROWS_AS(unsorted_root_hash(entries, &pool), std::invalid_argument);
+        }
+    }
+}
+
+}  // namespace silkworm::trie
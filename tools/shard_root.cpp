@@ -0,0 +1,49 @@
+/*
+   Copyright 2022 The Silkworm Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// Root hash of a file of sorted leaves, computed by worker processes:
+//   mpt-shard-root <leaves file> [processes] [split nibbles]
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+
+#include <merkle-patricia-tree/common/util.hpp>
+#include <merkle-patricia-tree/trie/sharded_root.hpp>
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::fprintf(stderr, "Usage: %s <leaves file> [processes] [split nibbles]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const size_t num_processes{argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0};
+    const size_t split_nibbles{argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1};
+    if (split_nibbles != 1 && split_nibbles != 2) {
+        std::fprintf(stderr, "split nibbles must be 1 or 2\n");
+        return EXIT_FAILURE;
+    }
+
+    try {
+        silkworm::trie::ShardedRootCoordinator coordinator{num_processes, split_nibbles};
+        const evmc::bytes32 root{coordinator.root_hash(std::filesystem::path{argv[1]})};
+        std::printf("%s\n", silkworm::to_hex(root.bytes, /*with_prefix=*/true).c_str());
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}